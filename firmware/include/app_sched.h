@@ -0,0 +1,49 @@
+#ifndef __APP_SCHED_H__
+#define __APP_SCHED_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Application schedule
+//
+// Which work each scheduled wake-up does and when it comes back, decided from the device
+// state. The contact wake-ups follow the hall sensor and are not scheduled.
+// Plain C without SDK dependencies: main.c runs the jobs and arms the alarms, the host
+// power simulator (tools/power_sim) links the same decisions.
+
+// wake-ups of the application
+enum app_wake {
+	APP_WAKE_SENSOR,		// temperature & humidity check
+	APP_WAKE_BATTERY,		// battery check
+	APP_WAKE_COUNT
+};
+
+// jobs of a wake-up
+#define APP_JOB_SAMPLE		(1u << 0)	// temperature & humidity burst, filter and attributes
+#define APP_JOB_BATTERY		(1u << 1)	// battery measurement, poll interval and diagnostics
+#define APP_JOB_TIME_SYNC	(1u << 2)	// time request if one is due (timebase_poll)
+#define APP_JOB_PERSIST		(1u << 3)	// write the persisted state if due (persist_flush)
+
+struct app_state {
+	bool joined;
+	bool sensor_ok;			// temperature & humidity sensor found at boot
+	bool restored;			// persisted state restored at the join
+	uint8_t battery_phase;	// sensor cycles since the last battery check (persist_data)
+};
+
+// jobs of a wake-up in the given state
+uint32_t app_sched_jobs(enum app_wake wake, const struct app_state *state);
+
+// delay in ms of the first wake-up after joining, 0: not scheduled
+uint32_t app_sched_first(enum app_wake wake, const struct app_state *state);
+
+// delay in ms until the wake-up comes back, 0: not rescheduled
+uint32_t app_sched_next(enum app_wake wake, const struct app_state *state);
+
+// time sync interval after a sync that found the local time off by error_ms
+uint32_t app_sched_sync_interval(uint32_t interval_ms, int32_t error_ms, uint32_t accuracy_ms);
+
+// poll and keepalive interval in ms for an LF clock accuracy
+uint32_t app_sched_poll_interval(uint32_t accuracy_ppm);
+
+#endif // __APP_SCHED_H__
@@ -0,0 +1,24 @@
+#ifndef __BATTERY_LEVEL_H__
+#define __BATTERY_LEVEL_H__
+
+#include <stdint.h>
+
+// NiMH cell level from its voltage
+//
+// Piecewise linear discharge curve of a low self-discharge NiMH cell.
+// Plain C without SDK dependencies: main.c converts the battery measurement, the host
+// power simulator (tools/power_sim) derives the cell voltage from the charge used.
+
+// voltage-capacity pair of the discharge curve
+typedef struct {
+  uint16_t      voltage;
+  uint8_t       capacity;
+} voltage_capacity_pair_t;
+
+// remaining capacity in percent for a cell voltage in mV
+uint8_t NiMH_CalculateLevel (uint16_t voltage);
+
+// cell voltage in mV for a remaining capacity in per mille, the inverse of the curve
+uint16_t NiMH_CalculateVoltage (uint16_t level_permille);
+
+#endif // __BATTERY_LEVEL_H__
@@ -0,0 +1,26 @@
+#ifndef __BOOT_PROF_H__
+#define __BOOT_PROF_H__
+
+#include <stdint.h>
+
+// Boot phase timestamps
+//
+// Each phase records the uptime of its first occurrence after a reset, so battery insertion
+// and recovery times can be read from the log (EVT_BOOT_PHASE events) and tracked.
+
+enum boot_phase {
+	BOOT_PHASE_MAIN,			// main() entered
+	BOOT_PHASE_GPIO,			// LEDs, button and hall sensor configured
+	BOOT_PHASE_STACK_ENABLED,	// Zigbee thread started
+	BOOT_PHASE_SENSOR_READY,	// HDC2080 bring-up finished (ok or degraded)
+	BOOT_PHASE_STACK_STARTED,	// stack signalled startup (NVRAM loaded)
+	BOOT_PHASE_JOINED,			// joined or rejoined the network
+	BOOT_PHASE_FIRST_SLEEP,		// stack allowed the device to sleep for the first time
+	BOOT_PHASE_FIRST_REPORT,	// first measurement set while joined, i.e. queued for reporting
+	BOOT_PHASE_COUNT
+};
+
+// record the first occurrence of a boot phase, later calls are ignored
+void boot_phase_mark(enum boot_phase phase);
+
+#endif // __BOOT_PROF_H__
@@ -0,0 +1,45 @@
+#ifndef __DELIVERY_H__
+#define __DELIVERY_H__
+
+#include <stdint.h>
+#include <zboss_api.h>
+
+// Delivery policy per message class
+//
+// Each class holds at most one message. A send is confirmed by the APS acknowledgement of the
+// destination, a reliable class sends a failed message (or one that found no buffer) again
+// after a delay that doubles with every retry. A newer message of the same class replaces the
+// pending one, so only the latest state is ever repeated. Best-effort classes have no retries,
+// the next message replaces a lost one. Measurement reports belong to the second kind but stay
+// with the ZBOSS reporting engine, which only ever sends the latest value.
+
+// Message classes: X(id, name, retries)
+#define DELIVERY_CLASSES(X)												\
+	X(DELIVERY_CONTACT,	"contact",	CONFIG_ZICADA_DELIVERY_RETRIES)		\
+	X(DELIVERY_TIME,	"time",		0)
+
+#define DELIVERY_ENUM(id, name, retries) id,
+
+enum delivery_class {
+	DELIVERY_CLASSES(DELIVERY_ENUM)
+	DELIVERY_CLASS_COUNT
+};
+
+// builds the frame in bufid and sends it with confirm as the ZCL send callback
+typedef void (*delivery_send_t)(zb_bufid_t bufid, zb_uint16_t arg, zb_callback_t confirm);
+
+struct delivery_stats {
+	uint16_t sent[DELIVERY_CLASS_COUNT];		// messages, not counting retries
+	uint16_t confirmed[DELIVERY_CLASS_COUNT];
+	uint16_t retries[DELIVERY_CLASS_COUNT];
+	uint16_t dropped[DELIVERY_CLASS_COUNT];		// failed or found no buffer after the last retry
+	uint16_t superseded[DELIVERY_CLASS_COUNT];	// replaced by a newer message before confirmed
+};
+
+// send a message of a class, replaces a pending one, call from the Zigbee thread. Returns an
+// error if the message was dropped right away (no buffer and no retries left).
+zb_ret_t delivery_send(enum delivery_class cls, delivery_send_t send, zb_uint16_t arg);
+
+const struct delivery_stats *delivery_get(void);
+
+#endif // __DELIVERY_H__
@@ -0,0 +1,77 @@
+#ifndef __EVT_LOG_H__
+#define __EVT_LOG_H__
+
+#include <stdint.h>
+
+// Binary event log
+//
+// Fixed-size records (timestamp, event id, two arguments) are written in O(1) into a ring
+// buffer that survives warm resets. Nothing is formatted on the device: the ring is dumped
+// as hex over RTT and turned back into text by tools/evt_log_decode.py.
+
+// Event table: X(id, format)
+//
+// The host decoder parses this table, so keep one entry per line and only append new
+// events at the end (the position in the table is the id stored in the record).
+// Format fields: {a0} = 16 bit argument, {a1} = 32 bit argument, {a0_c} / {a1_c} = same
+// value in hundredths (e.g. ZCL temperature), {a0_x} / {a1_x} = hex.
+// Events that are no longer recorded keep their entry, so older captures still decode
+// (EVT_FIRST_SLEEP is now the first sleep phase of EVT_BOOT_PHASE).
+#define EVT_LOG_EVENTS(X)																		\
+	X(EVT_BOOT,					"boot #{a1}, reset cause {a0_x}")								\
+	X(EVT_JOINED,				"joined network")												\
+	X(EVT_LEFT,					"left network")													\
+	X(EVT_TEMP_UPDATE,			"temperature attribute update: {a1_c} C")						\
+	X(EVT_HUMIDITY_UPDATE,		"humidity attribute update: {a1_c} %")							\
+	X(EVT_BATTERY_UPDATE,		"battery attribute update: {a1} mV / {a0} %")					\
+	X(EVT_ATTR_SET_FAILED,		"failed to set attribute of cluster {a1_x}: status {a0}")		\
+	X(EVT_ALARM_FAILED,			"failed to schedule alarm {a1_x}: error {a0}")					\
+	X(EVT_CONTACT,				"hall sensor {a0} - sending On/Off command {a1}")				\
+	X(EVT_REJOIN_ATTEMPT,		"waking up Zigbee stack for rejoin")							\
+	X(EVT_FIRST_SLEEP,			"boot to first sleep: {a1} ms (warm restart: {a0})")			\
+	X(EVT_STATE_RESTORED,		"restored persisted state, battery phase {a0}")				\
+	X(EVT_SENSOR_FAILED,		"temperature & humidity sensor failed: error {a0}")				\
+	X(EVT_PM_STATE,				"peripheral {a0} {a1} (1 = active, 0 = suspended)")				\
+	X(EVT_SAMPLE_REJECTED,		"filter rejected sample of cluster {a0_x}: {a1_c}")			\
+	X(EVT_WDT_LATE,				"watchdog task {a0} late by {a1} ms, feed withheld")			\
+	X(EVT_WARM_RECOVERY,		"resumed from retained snapshot, contact {a0}, warm restart #{a1}")	\
+	X(EVT_TIME_SYNC,			"time synced: {a1} s since 2000 UTC, drift {a0} ppm")			\
+	X(EVT_LFCLK_PROBE,			"LF clock status {a0_x}, source accuracy {a1} ppm")			\
+	X(EVT_DELIVERY_DROPPED,		"dropped message of delivery class {a0}, argument {a1}")		\
+	X(EVT_BOOT_PHASE,			"boot phase {a0} reached after {a1} ms")
+
+#define EVT_LOG_ENUM(id, fmt) id,
+
+enum evt_log_id {
+	EVT_LOG_EVENTS(EVT_LOG_ENUM)
+	EVT_LOG_ID_COUNT
+};
+
+// one log record, 12 bytes
+struct evt_log_rec {
+	uint32_t timestamp;		// ms since boot
+	uint16_t id;			// enum evt_log_id
+	int16_t arg0;
+	int32_t arg1;
+};
+
+#ifdef CONFIG_ZICADA_EVT_LOG
+
+// validate the retained ring after a reset and record the boot event
+void evt_log_init(uint16_t reset_cause);
+
+// append a record, safe to call from ISRs
+void evt_log_put(enum evt_log_id id, int16_t arg0, int32_t arg1);
+
+// print the ring as hex lines over the console (RTT) for the host decoder
+void evt_log_dump(void);
+
+#else
+
+static inline void evt_log_init(uint16_t reset_cause) { (void)reset_cause; }
+static inline void evt_log_put(enum evt_log_id id, int16_t arg0, int32_t arg1) { (void)id; (void)arg0; (void)arg1; }
+static inline void evt_log_dump(void) { }
+
+#endif // CONFIG_ZICADA_EVT_LOG
+
+#endif // __EVT_LOG_H__
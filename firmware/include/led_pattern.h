@@ -0,0 +1,33 @@
+#ifndef __LED_PATTERN_H__
+#define __LED_PATTERN_H__
+
+#include <stdbool.h>
+
+// LED pattern engine
+//
+// Blink sequences are played by the PWM peripheral straight from RAM (EasyDMA), with one
+// PWM period per 100 ms step, so the CPU is not woken up until the next call. When no
+// pattern plays, the pin shows the steady base state from its GPIO output register.
+
+enum led_pattern {
+	LED_PATTERN_IDENTIFY,		// 100 ms on / 100 ms off until stopped
+	LED_PATTERN_JOINING,		// three short blinks on a rejoin attempt
+	LED_PATTERN_CONTACT,		// 500 ms flash on a contact change
+	LED_PATTERN_LOW_BATTERY,	// two short blinks after a low battery reading
+	LED_PATTERN_FACTORY_RESET,	// one second of fast blinking
+	LED_PATTERN_COUNT
+};
+
+// configure the PWM instance for the network state LED, call after dk_leds_init()
+int led_pattern_init(void);
+
+// steady state shown whenever no pattern plays (on: not joined, off: normal operation)
+void led_pattern_set_base(bool on);
+
+// start a pattern, replacing the one currently playing
+void led_pattern_play(enum led_pattern pattern);
+
+// stop the current pattern and return to the base state
+void led_pattern_stop(void);
+
+#endif // __LED_PATTERN_H__
@@ -0,0 +1,53 @@
+#ifndef __LFCLK_MGR_H__
+#define __LFCLK_MGR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/sys/util.h>
+
+#include "zicada_params.h"
+
+// LF clock manager
+//
+// The 32 kHz source is a build option owned by MPSL, which starts the clock and runs the RC
+// calibration. The manager probes for the crystal at boot, before MPSL takes the clock,
+// and reports a build that does not match the board. It shortens the poll and keepalive
+// interval below LONG_POLL_INTERVAL_MSEC by the clock accuracy: the spec of the source until
+// the timebase has measured the drift, then the measured drift.
+
+// status bits
+#define LFCLK_STATUS_PROBED			BIT(0)	// the crystal probe ran (LF clock was stopped at boot)
+#define LFCLK_STATUS_XTAL_FITTED	BIT(1)	// the crystal started
+#define LFCLK_STATUS_XTAL_BUILD		BIT(2)	// built for the crystal
+#define LFCLK_STATUS_MISMATCH		BIT(3)	// build and board disagree
+#define LFCLK_STATUS_MEASURED		BIT(4)	// accuracy from the measured drift
+
+struct lfclk_stats {
+	uint8_t status;				// LFCLK_STATUS_*
+	uint16_t accuracy_ppm;		// clock accuracy the timing windows are sized for
+	int16_t drift_ppm;			// measured drift, 0 until measured
+	int16_t time_error_ms;		// error of the local time found at the latest time sync
+	uint32_t cal_saved;			// forced RC calibrations avoided against the SDK defaults, estimated
+							// from uptime and the configured rates (not counted)
+	uint32_t poll_interval_ms;	// current poll and keepalive interval
+};
+
+#ifdef CONFIG_ZICADA_LFCLK_MGR
+
+// report the probe result, call once from main()
+void lfclk_mgr_init(void);
+
+// refresh the accuracy and the statistics, returns the poll and keepalive interval to use
+uint32_t lfclk_mgr_update(void);
+
+const struct lfclk_stats *lfclk_mgr_get(void);
+
+#else
+
+static inline void lfclk_mgr_init(void) {}
+static inline uint32_t lfclk_mgr_update(void) { return LONG_POLL_INTERVAL_MSEC; }
+static inline const struct lfclk_stats *lfclk_mgr_get(void) { static const struct lfclk_stats none; return &none; }
+
+#endif // CONFIG_ZICADA_LFCLK_MGR
+
+#endif // __LFCLK_MGR_H__
@@ -0,0 +1,47 @@
+#ifndef __MEM_STATS_H__
+#define __MEM_STATS_H__
+
+#include <stdint.h>
+
+// Stack and heap high-water marks
+//
+// Stacks are painted at thread creation (CONFIG_INIT_STACKS), so the deepest use since boot
+// can be read back at any time. The marks are printed as "MEM <name> <size> <used>" lines
+// for tools/right_size.py, which turns captures of worst-case runs into tightened sizes.
+
+enum mem_stats_thread {
+	MEM_STATS_ZBOSS,
+	MEM_STATS_MAIN,
+	MEM_STATS_LOG,
+	MEM_STATS_WORKQ,
+	MEM_STATS_IDLE,
+	MEM_STATS_THREAD_COUNT
+};
+
+struct mem_stats {
+	uint32_t stack_size[MEM_STATS_THREAD_COUNT];
+	uint32_t stack_used[MEM_STATS_THREAD_COUNT];	// 0 if the thread was not found
+	uint32_t heap_size;
+	uint32_t heap_max_used;
+};
+
+#ifdef CONFIG_ZICADA_MEM_STATS
+
+// scan the thread stacks and the system heap, takes a few hundred us per KB of stack
+void mem_stats_update(void);
+
+// last values from mem_stats_update()
+const struct mem_stats *mem_stats_get(void);
+
+// print the values for tools/right_size.py
+void mem_stats_print(void);
+
+#else
+
+static inline void mem_stats_update(void) {}
+static inline const struct mem_stats *mem_stats_get(void) { static const struct mem_stats none; return &none; }
+static inline void mem_stats_print(void) {}
+
+#endif
+
+#endif // __MEM_STATS_H__
@@ -0,0 +1,38 @@
+#ifndef __PERIPH_PM_H__
+#define __PERIPH_PM_H__
+
+#include <stdint.h>
+
+// Peripheral power management
+//
+// Reference counted get/put around every use of a peripheral. The I2C bus is suspended
+// through Zephyr's device runtime PM, the SAADC (driven by nrfx directly) is initialized
+// and torn down on the first get / last put. The HDC2080 itself needs no action: in the
+// one-shot mode used by the driver it returns to sleep after each conversion.
+
+enum periph_pm_res {
+	PERIPH_PM_I2C,		// i2c0 (TWIM) with the HDC2080
+	PERIPH_PM_SAADC,	// battery voltage measurement
+	PERIPH_PM_COUNT
+};
+
+// usage statistics per peripheral
+struct periph_pm_stats {
+	uint32_t activations;	// number of suspended -> active transitions
+	uint32_t active_ms;		// total time spent active
+	uint32_t errors;		// failed get / put calls
+};
+
+// enable runtime PM for the managed devices, suspends them until first use
+void periph_pm_init(void);
+
+// take a reference, the peripheral is active on return if 0 is returned
+int periph_pm_get(enum periph_pm_res res);
+
+// release a reference, the last put suspends the peripheral
+int periph_pm_put(enum periph_pm_res res);
+
+// copy the usage statistics of a peripheral
+void periph_pm_stats_get(enum periph_pm_res res, struct periph_pm_stats *stats);
+
+#endif // __PERIPH_PM_H__
@@ -0,0 +1,54 @@
+#ifndef __PERSIST_H__
+#define __PERSIST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "persist_store.h"
+
+// Application state kept in the ZBOSS NVRAM application dataset so that a reset does not
+// re-register reporting from scratch or re-report values the coordinator already has.
+//
+// The live copy is a snapshot in retained RAM (see retained.h). After a reset that kept the
+// device powered (watchdog, fault, pin reset) the snapshot is used instead of the NVRAM
+// dataset: it is never older than the last write and also holds the state that changes too
+// often to be written to flash. A CRC guards it, a mismatch falls back to the cold path.
+
+// The dataset (struct persist_data) and when it is written are in persist_policy.h, the
+// snapshot and how a start picks it or the NVRAM dataset in persist_store.h.
+
+// validate the retained snapshot (only trusted if warm is set) and register the NVRAM
+// callbacks, call before zigbee_enable()
+void persist_init(bool warm);
+
+// true if the state was resumed from the snapshot or a valid dataset was loaded from NVRAM
+// during stack startup
+bool persist_restored(void);
+
+// true if the state was resumed from the retained snapshot
+bool persist_warm_restored(void);
+
+// retained-only state, zeroed after a power-on reset. Call persist_seal() after changing it.
+struct persist_warm *persist_get_warm(void);
+
+// update the snapshot checksum after a change of the live state, a snapshot left unsealed by
+// a reset is not resumed. persist_mark() seals as well.
+void persist_seal(void);
+
+// forget the persisted values so that they are not resumed or restored (e.g. after a factory
+// reset), the retained-only counters are kept
+void persist_invalidate(void);
+
+// live copy of the persisted state, update it and mark the changed part with persist_mark()
+struct persist_data *persist_get(void);
+
+// mark a part of the dataset as changed, it is written by a later persist_flush()
+void persist_mark(uint8_t dirty);
+
+// write the dataset if a change is due (persist_policy.c), call from a wake-up of the Zigbee
+// thread that happens anyway
+void persist_flush(void);
+
+const struct persist_stats *persist_get_stats(void);
+
+#endif // __PERSIST_H__
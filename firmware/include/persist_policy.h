@@ -0,0 +1,63 @@
+#ifndef __PERSIST_POLICY_H__
+#define __PERSIST_POLICY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// When the persisted state is worth an NVRAM write
+//
+// A changed reporting state is written with the next flush. Attribute values are looked at
+// once per CONFIG_ZICADA_PERSIST_SAVE_CYCLES sensor check periods and only written if they
+// moved by CONFIG_ZICADA_PERSIST_MIN_CHANGE, so repeated updates end up in one write. The
+// age is kept in time, so it does not matter which wake-up flushes.
+// Plain C without SDK dependencies: persist.c does the writes, the host power simulator
+// (tools/power_sim) and the tests link the same decisions.
+
+#define PERSIST_VERSION						1
+
+// flags
+#define PERSIST_FLAG_REPORTING_CONFIGURED	(1u << 0)
+
+// dirty parts of the dataset, see persist_mark()
+#define PERSIST_DIRTY_CONFIG				(1u << 0)	// flags, written with the next flush
+#define PERSIST_DIRTY_VALUES				(1u << 1)	// attribute values, written when old and changed enough
+
+// NVRAM payload, size must be a multiple of 4 bytes
+struct persist_data {
+	uint8_t version;
+	uint8_t flags;
+	uint8_t battery_percent;	// last battery percentage remaining attribute (ZCL half percent)
+	uint8_t battery_phase;		// temperature & humidity cycles since the last battery check
+	int16_t temperature;		// last temperature attribute (0.01 C)
+	int16_t humidity;			// last humidity attribute (0.01 %)
+};
+
+enum persist_decision {
+	PERSIST_WAIT,				// nothing due yet
+	PERSIST_SKIP,				// the values did not move enough, forgotten until the next change
+	PERSIST_WRITE,				// write the dataset, then persist_policy_result()
+};
+
+struct persist_policy {
+	struct persist_data written;	// dataset as last written or loaded
+	uint8_t dirty;
+	int64_t last_check;				// ms, uptime the values were last looked at
+};
+
+// reset the policy after boot, nothing is known to be written
+void persist_policy_init(struct persist_policy *p);
+
+// the dataset found in NVRAM
+void persist_policy_loaded(struct persist_policy *p, const struct persist_data *data);
+
+// mark parts of the dataset as changed
+void persist_policy_mark(struct persist_policy *p, uint8_t parts);
+
+// decide a flush of the live state at uptime now_ms
+enum persist_decision persist_policy_check(struct persist_policy *p, const struct persist_data *data,
+	int64_t now_ms);
+
+// outcome of the write after PERSIST_WRITE, a failed write stays dirty and is tried again
+void persist_policy_result(struct persist_policy *p, const struct persist_data *data, bool ok);
+
+#endif // __PERSIST_POLICY_H__
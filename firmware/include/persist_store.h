@@ -0,0 +1,95 @@
+#ifndef __PERSIST_STORE_H__
+#define __PERSIST_STORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "persist_policy.h"
+
+// Persisted state across resets and power loss
+//
+// The live state is a snapshot in retained RAM, sealed with a CRC-32 after every change. A
+// warm reset resumes a valid snapshot, anything else (power-on, a random or torn block)
+// starts cold from the NVRAM dataset, which is only taken with the expected size and
+// version. The snapshot also keeps the dataset last written, so a resumed state is only
+// written again when it holds changes the flash does not have.
+// Plain C without SDK dependencies: persist.c adds the NVRAM access and the logging, the
+// host tests (tests/test_persist.c) run the same code on an emulated flash.
+
+#define PERSIST_SNAPSHOT_MAGIC				0x5A505353UL	// "ZPSS"
+
+// flags of the retained-only state
+#define PERSIST_WARM_DRIFT_MEASURED			(1u << 0)	// lf_drift_ppm holds a measurement
+
+// state only kept in the retained snapshot
+struct persist_warm {
+	uint8_t hall_state;			// last contact state the On/Off command was sent for
+	uint8_t flags;				// PERSIST_WARM_*
+	uint16_t warm_restarts;		// resets resumed from the snapshot since power-on
+	uint16_t wdt_resets;		// watchdog resets since power-on
+	int16_t lf_drift_ppm;		// LF clock drift measured by the timebase (timebase.c)
+};
+
+// live state in noinit RAM, random after a power-on reset
+struct persist_snapshot {
+	uint32_t magic;
+	struct persist_data data;
+	struct persist_data written;	// dataset last written to or loaded from NVRAM
+	struct persist_warm warm;
+	uint32_t crc;					// CRC-32 of everything between magic and crc
+};
+
+// NVRAM writes of the dataset, each write appends a copy to the active NVRAM page
+struct persist_stats {
+	uint16_t writes;
+	uint16_t skipped;			// flushes of values that did not change enough to be written
+};
+
+// writes the snapshot's data as the NVRAM dataset, 0 on success
+typedef int (*persist_write_t)(void);
+
+struct persist_store {
+	struct persist_snapshot *snapshot;
+	persist_write_t write;
+	struct persist_policy policy;
+	struct persist_stats stats;
+	bool restored;				// resumed from the snapshot or loaded from NVRAM
+	bool warm_restored;			// resumed from the snapshot
+};
+
+enum persist_start {
+	PERSIST_START_COLD,			// power-on reset, the snapshot starts empty
+	PERSIST_START_CORRUPT,		// warm reset with a random or torn snapshot, started cold
+	PERSIST_START_RETAINED,		// warm reset before reporting ran, only the retained-only state is kept
+	PERSIST_START_WARM,			// state resumed from the snapshot
+};
+
+enum persist_load {
+	PERSIST_LOAD_OK,
+	PERSIST_LOAD_IGNORED,		// the resumed snapshot is at least as new
+	PERSIST_LOAD_SIZE,			// unexpected dataset size
+	PERSIST_LOAD_VERSION,		// unsupported dataset version
+};
+
+// check the snapshot (only trusted if warm is set) and start from it or cold, before the
+// NVRAM dataset is loaded
+enum persist_start persist_store_start(struct persist_store *st, bool warm);
+
+// take the dataset found in NVRAM with its stored length, data is only looked at if the
+// length fits
+enum persist_load persist_store_load(struct persist_store *st, const struct persist_data *data,
+	uint16_t length);
+
+// update the checksum after a change of the snapshot
+void persist_store_seal(struct persist_store *st);
+
+// seal and mark parts of the dataset as changed
+void persist_store_mark(struct persist_store *st, uint8_t parts);
+
+// write the dataset if the policy says so, returns the error of a failed write or 0
+int persist_store_flush(struct persist_store *st, int64_t now_ms);
+
+// forget the persisted values, the retained-only state is kept
+void persist_store_invalidate(struct persist_store *st);
+
+#endif // __PERSIST_STORE_H__
@@ -0,0 +1,67 @@
+#ifndef __RES_STATS_H__
+#define __RES_STATS_H__
+
+#include <stdint.h>
+
+// ZBOSS resource headroom
+//
+// ZBOSS does not expose the fill level of its scheduler and buffer pools, so the free room
+// is probed from the Zigbee thread: buffers are taken until the pool refuses and alarms are
+// scheduled until the table is full, then everything is given back before the stack runs
+// again. Probes run at the busy moments (a contact change, a report cycle) and keep the
+// lowest free room seen. Failures are counted where the application schedules, allocates
+// and writes NVRAM, the NVRAM fill is read from the flash pages. The values are printed as
+// "RES <name> <size> <min free> <failures>" lines for tools/right_size.py.
+//
+// The growth of the NVRAM fill between reads also gives the write rate of ZBOSS and the
+// application together, and from it the flash lifetime.
+
+enum res_stats_res {
+	RES_STATS_SCHED,	// callback queue, failures only (its entries cannot be taken back)
+	RES_STATS_ALARM,	// alarm table
+	RES_STATS_BUF_IN,	// buffer pool, in direction (half the pool)
+	RES_STATS_BUF_OUT,	// buffer pool, out direction (half the pool)
+	RES_STATS_NVRAM,	// NVRAM page in bytes
+	RES_STATS_RES_COUNT
+};
+
+struct res_stats {
+	uint32_t size[RES_STATS_RES_COUNT];		// configured entries, buffers or page bytes
+	uint32_t min_free[RES_STATS_RES_COUNT];	// lowest free room seen, size until probed
+	uint16_t failures[RES_STATS_RES_COUNT];
+	uint32_t nvram_written;		// bytes appended to the NVRAM pages by all writers since boot
+	uint16_t nvram_erases;		// page erases seen since boot (the fill of the pages dropped)
+	uint16_t nvram_lifetime;	// days until the flash endurance is used up at this rate
+};
+
+#ifdef CONFIG_ZICADA_RES_STATS
+
+// set the configured sizes from zb_mem_config_custom.h
+void res_stats_init(uint32_t sched_q_size, uint32_t iobuf_pool_size);
+
+// probe the scheduler and buffer pools, call from the Zigbee thread only
+void res_stats_sample(void);
+
+// read the NVRAM page fill, takes a flash read of the free part of each page
+void res_stats_update(void);
+
+// count an allocation or scheduling failure, safe to call from ISRs
+void res_stats_fail(enum res_stats_res res);
+
+const struct res_stats *res_stats_get(void);
+
+// print the values for tools/right_size.py
+void res_stats_print(void);
+
+#else
+
+static inline void res_stats_init(uint32_t sched_q_size, uint32_t iobuf_pool_size) { (void)sched_q_size; (void)iobuf_pool_size; }
+static inline void res_stats_sample(void) {}
+static inline void res_stats_update(void) {}
+static inline void res_stats_fail(enum res_stats_res res) { (void)res; }
+static inline const struct res_stats *res_stats_get(void) { static const struct res_stats none; return &none; }
+static inline void res_stats_print(void) {}
+
+#endif
+
+#endif // __RES_STATS_H__
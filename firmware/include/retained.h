@@ -0,0 +1,13 @@
+#ifndef __RETAINED_H__
+#define __RETAINED_H__
+
+// State that must survive a warm reset
+//
+// Objects tagged __zicada_retained are not initialized at boot and are linked next to each
+// other in the noinit area (linker/retained.ld), so the must-survive state stays in one small
+// block instead of being spread over the RAM sections. Every user validates its own content
+// (magic / checksum) because it is random after a power-on reset.
+
+#define __zicada_retained __attribute__((__section__(".zicada_retained"), __used__))
+
+#endif // __RETAINED_H__
@@ -0,0 +1,47 @@
+#ifndef __SENSOR_FILTER_H__
+#define __SENSOR_FILTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sensor signal conditioning
+//
+// Integer-only pipeline between sampling and attribute update:
+//   burst of samples -> median -> plausibility / rate-of-change gate -> EMA smoothing
+// Values are in the attribute unit (hundredths). The cost per sample is bounded by the
+// burst size (at most SENSOR_FILTER_MAX_BURST elements are sorted).
+
+#define SENSOR_FILTER_MAX_BURST 9
+
+// fractional bits of the EMA state
+#define SENSOR_FILTER_EMA_FRAC 8
+
+struct sensor_filter_cfg {
+	int32_t min;			// plausible range of the sensor
+	int32_t max;
+	int32_t max_step;		// largest accepted change between two accepted samples, 0: no limit
+	uint8_t max_rejects;	// accept anyway after this many consecutive rejections (real step change)
+	uint8_t ema_shift;		// EMA weight of a new sample is 1 / 2^ema_shift, 0: no smoothing
+};
+
+struct sensor_filter {
+	const struct sensor_filter_cfg *cfg;
+	int32_t ema;			// smoothed value << SENSOR_FILTER_EMA_FRAC
+	int32_t last;			// last accepted raw sample
+	uint8_t rejects;		// consecutive rejections
+	bool seeded;
+	uint32_t rejected;		// total rejected samples
+	uint32_t accepted;		// total accepted samples
+};
+
+// reset a filter, the next accepted sample seeds it
+void sensor_filter_init(struct sensor_filter *f, const struct sensor_filter_cfg *cfg);
+
+// median of a burst, sorts the samples in place (n <= SENSOR_FILTER_MAX_BURST)
+int32_t sensor_filter_median(int32_t *samples, uint8_t n);
+
+// run one sample through the gate and the EMA, returns false if the sample was rejected
+// (out is left untouched in that case)
+bool sensor_filter_update(struct sensor_filter *f, int32_t sample, int32_t *out);
+
+#endif // __SENSOR_FILTER_H__
@@ -0,0 +1,51 @@
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zboss_api.h>
+
+// Wall-clock time from the coordinator
+//
+// Now and then the Time attribute of the coordinator's Time cluster is read and UTC is
+// kept on top of the uptime (the RTC on the LF clock). The LF clock drift is measured
+// between syncs and compensated, so the time also holds with the RC oscillator. The sync
+// interval doubles while the time is within CONFIG_ZICADA_TIMEBASE_ACCURACY_MS at a sync
+// and halves when it is not. Requests only go out from a wake-up that already happens,
+// the sensor and the battery checks (the latter also in degraded mode).
+//
+// Times are in ms since 2000-01-01 00:00 UTC, the ZCL epoch.
+
+#ifdef CONFIG_ZICADA_TIMEBASE
+
+// seed the drift estimate from the retained snapshot, call after persist_init()
+void timebase_init(void);
+
+// send a Time read if a sync is due, call from the Zigbee thread on an existing wake-up
+void timebase_poll(void);
+
+// endpoint handler part for the Time cluster responses, ZB_TRUE if the buffer was consumed
+zb_uint8_t timebase_zcl_handler(zb_bufid_t bufid);
+
+// current UTC, false until the first sync
+bool timebase_now(int64_t *utc_ms);
+
+// uptime at which a UTC time is reached, to schedule work at a wall-clock time
+bool timebase_uptime_at(int64_t utc_ms, int64_t *uptime_ms);
+
+// measured LF clock drift and the error of the local time at the latest sync, false until
+// the drift has been measured
+bool timebase_drift(int32_t *ppm, int32_t *error_ms);
+
+#else
+
+static inline void timebase_init(void) {}
+static inline void timebase_poll(void) {}
+static inline zb_uint8_t timebase_zcl_handler(zb_bufid_t bufid) { (void)bufid; return ZB_FALSE; }
+static inline bool timebase_now(int64_t *utc_ms) { (void)utc_ms; return false; }
+static inline bool timebase_uptime_at(int64_t utc_ms, int64_t *uptime_ms) { (void)utc_ms; (void)uptime_ms; return false; }
+static inline bool timebase_drift(int32_t *ppm, int32_t *error_ms) { (void)ppm; (void)error_ms; return false; }
+
+#endif // CONFIG_ZICADA_TIMEBASE
+
+#endif // __TIMEBASE_H__
@@ -0,0 +1,49 @@
+#ifndef __WDT_SUP_H__
+#define __WDT_SUP_H__
+
+#include <stdint.h>
+
+// Watchdog supervision
+//
+// The hardware watchdog keeps counting while the SoC sleeps and is only fed when every
+// supervised task has shown progress within its deadline. A task is armed while it has
+// work outstanding (a scheduled check, an unhandled contact change), a disarmed task never
+// holds back the feed. The feed is done from the check-ins themselves plus a slow heartbeat
+// alarm, so supervision adds almost no wake-ups.
+
+enum wdt_sup_task {
+	WDT_SUP_ZIGBEE,		// Zigbee thread, any check-in and the heartbeat alarm
+	WDT_SUP_SENSOR,		// temperature & humidity check, armed while it is scheduled
+	WDT_SUP_CONTACT,	// hall sensor path, armed from the interrupt until the command is queued
+	WDT_SUP_TASK_COUNT
+};
+
+#ifdef CONFIG_ZICADA_WATCHDOG
+
+// install the timeout and start the watchdog, call early in main()
+int wdt_sup_init(void);
+
+// start the heartbeat alarm, call after zigbee_enable()
+void wdt_sup_start(void);
+
+// task has work outstanding and must check in within its deadline, safe to call from ISRs
+void wdt_sup_arm(enum wdt_sup_task task);
+
+// task is idle and no longer supervised
+void wdt_sup_disarm(enum wdt_sup_task task);
+
+// record progress of a task and feed the watchdog if all armed tasks are on time,
+// call from the Zigbee thread only
+void wdt_sup_checkin(enum wdt_sup_task task);
+
+#else
+
+static inline int wdt_sup_init(void) { return 0; }
+static inline void wdt_sup_start(void) {}
+static inline void wdt_sup_arm(enum wdt_sup_task task) {}
+static inline void wdt_sup_disarm(enum wdt_sup_task task) {}
+static inline void wdt_sup_checkin(enum wdt_sup_task task) {}
+
+#endif
+
+#endif // __WDT_SUP_H__
@@ -8,6 +8,20 @@
 #define ZB_MEM_CONFIG_CUSTOM_H 1
 
 
+#if defined(CONFIG_ZIGBEE_ROLE_ROUTER)
+
+/* Mains (USB) powered router: routing and neighbor tables for a real mesh. */
+#define ZB_CONFIG_ROLE_ZR
+
+#define ZB_CONFIG_OVERALL_NETWORK_SIZE 128
+
+/**
+ * Routing of other devices' traffic besides our own reports.
+ */
+#define ZB_CONFIG_MODERATE_TRAFFIC
+
+#else
+
 #define ZB_CONFIG_ROLE_ZED
 #define ZB_CONFIG_OVERALL_NETWORK_SIZE 16
 
@@ -16,6 +30,8 @@
  */
 #define ZB_CONFIG_LIGHT_TRAFFIC
 
+#endif
+
 /**
  * Simple user's application at that device: not too many relations
  * to other devices.
@@ -1,97 +1,94 @@
 #ifndef __ZB_ZICADA_H__
 #define __ZB_ZICADA_H__
 
+#include <zephyr/toolchain.h>
+
+#include "zcl_zicada_diag.h"
+
 // Temperature sensor device ID
 #define ZB_TEMPERATURE_SENSOR_DEVICE_ID 0x0302  
 
 // Device version
 #define ZB_DEVICE_VER_TEMPERATURE_SENSOR 0
 
-// Zicada sensor numer of IN (server) clusters
-#define ZB_ZICADA_IN_CLUSTER_NUM 5
+// Cluster table of the Zicada endpoint: X(cluster_id, role, attr_list, report_attr_count)
+//
+// cluster_id - ZCL cluster ID (enum constant)
+// role - SERVER (IN cluster) or CLIENT (OUT cluster)
+// attr_list - attribute list variable declared in main.c
+// report_attr_count - number of reportable attributes, sizes the reporting context
+//
+// The cluster list, the simple descriptor, the cluster counts and the reporting context
+// are all generated from this table. To add a cluster, add a line here, declare its
+// attribute list and update the literal counts below (the build checks them).
+
+#define ZB_ZICADA_CLUSTERS(X)																\
+	X(ZB_ZCL_CLUSTER_ID_BASIC,					SERVER,	basic_server_attr_list,				0)	\
+	X(ZB_ZCL_CLUSTER_ID_IDENTIFY,				CLIENT,	identify_client_attr_list,			0)	\
+	X(ZB_ZCL_CLUSTER_ID_IDENTIFY,				SERVER,	identify_server_attr_list,			0)	\
+	X(ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,		SERVER,	temperature_measurement_attr_list,		\
+		ZB_ZCL_TEMP_MEASUREMENT_REPORT_ATTR_COUNT)											\
+	X(ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,	SERVER,	humidity_measurement_attr_list,		\
+		ZB_ZCL_REL_HUMIDITY_MEASUREMENT_REPORT_ATTR_COUNT)									\
+	X(ZB_ZCL_CLUSTER_ID_ON_OFF,					CLIENT,	on_off_client_attr_list,			0)	\
+	X(ZB_ZCL_CLUSTER_ID_POWER_CONFIG,			SERVER,	power_config_server_attr_list,			\
+		ZB_ZCL_POWER_CONFIG_REPORT_ATTR_COUNT + 1) /* percentage, alarm state + voltage */	\
+	X(ZB_ZCL_CLUSTER_ID_ZICADA_DIAG,			SERVER,	diag_server_attr_list,				0)	\
+	X(ZB_ZCL_CLUSTER_ID_BINARY_INPUT,			SERVER,	binary_input_server_attr_list,			\
+		ZB_ZCL_BINARY_INPUT_REPORT_ATTR_COUNT) /* contact state */							\
+	X(ZB_ZCL_CLUSTER_ID_TIME,					CLIENT,	time_client_attr_list,				0)
 
-// Zicada sensor number of OUT (client) clusters
-#define ZB_ZICADA_OUT_CLUSTER_NUM 2
+// Zicada sensor number of IN (server) and OUT (client) clusters. These have to be literals
+// because ZB_DECLARE_SIMPLE_DESC() pastes them into a type name.
+#define ZB_ZICADA_IN_CLUSTER_NUM 7
+#define ZB_ZICADA_OUT_CLUSTER_NUM 3
 
 // Zicada sensor total number of (IN+OUT) clusters
 #define ZB_ZICADA_CLUSTER_NUM (ZB_ZICADA_IN_CLUSTER_NUM + ZB_ZICADA_OUT_CLUSTER_NUM)
 
-// Number of attributes for reporting on Zicada sensor
-// battery percentage remaining, battery alarm + battery voltage
-#define ZB_ZICADA_REPORT_ATTR_COUNT (ZB_ZCL_POWER_CONFIG_REPORT_ATTR_COUNT + 1)
+// table expanders
+#define ZB_ZICADA_ROLE_SERVER ZB_ZCL_CLUSTER_SERVER_ROLE
+#define ZB_ZICADA_ROLE_CLIENT ZB_ZCL_CLUSTER_CLIENT_ROLE
+
+#define ZB_ZICADA_IS_IN_SERVER 1
+#define ZB_ZICADA_IS_IN_CLIENT 0
+
+#define ZB_ZICADA_IN_ID_SERVER(cluster_id) cluster_id,
+#define ZB_ZICADA_IN_ID_CLIENT(cluster_id)
+#define ZB_ZICADA_OUT_ID_SERVER(cluster_id)
+#define ZB_ZICADA_OUT_ID_CLIENT(cluster_id) cluster_id,
+
+#define ZB_ZICADA_CLUSTER_DESC(cluster_id, role, attr_list, report_count)						\
+	ZB_ZCL_CLUSTER_DESC(cluster_id, ZB_ZCL_ARRAY_SIZE(attr_list, zb_zcl_attr_t), (attr_list),	\
+		ZB_ZICADA_ROLE_##role, ZB_ZCL_MANUF_CODE_INVALID),
+#define ZB_ZICADA_IN_ID(cluster_id, role, attr_list, report_count) ZB_ZICADA_IN_ID_##role(cluster_id)
+#define ZB_ZICADA_OUT_ID(cluster_id, role, attr_list, report_count) ZB_ZICADA_OUT_ID_##role(cluster_id)
+#define ZB_ZICADA_COUNT_IN(cluster_id, role, attr_list, report_count) + ZB_ZICADA_IS_IN_##role
+#define ZB_ZICADA_COUNT_OUT(cluster_id, role, attr_list, report_count) + (1 - ZB_ZICADA_IS_IN_##role)
+#define ZB_ZICADA_COUNT_REPORT(cluster_id, role, attr_list, report_count) + (report_count)
+
+// Number of attributes for reporting on Zicada sensor, exactly what the attribute lists
+// register so that no reporting slot is wasted or missing
+#define ZB_ZICADA_REPORT_ATTR_COUNT (0 ZB_ZICADA_CLUSTERS(ZB_ZICADA_COUNT_REPORT))
+
+BUILD_ASSERT(ZB_ZICADA_IN_CLUSTER_NUM == (0 ZB_ZICADA_CLUSTERS(ZB_ZICADA_COUNT_IN)),
+	"ZB_ZICADA_IN_CLUSTER_NUM does not match the server clusters in ZB_ZICADA_CLUSTERS");
+BUILD_ASSERT(ZB_ZICADA_OUT_CLUSTER_NUM == (0 ZB_ZICADA_CLUSTERS(ZB_ZICADA_COUNT_OUT)),
+	"ZB_ZICADA_OUT_CLUSTER_NUM does not match the client clusters in ZB_ZICADA_CLUSTERS");
 
 // Declare cluster list for Zicada sensor
 //
 // cluster_list_name - cluster list variable name
-// basic_server_attr_list - attribute list for Basic cluster (server role)
-// identify_server_attr_list - attribute list for Identify cluster (server role)
-// identify_client_attr_list - attribute list for Identify cluster (client role)
-// temperature_measurement_attr_list - attribute list for temperature cluster (server role)
-// humidity_measurement_attr_list - attribute list for humidity cluster (server role)
-// on_off_client_attr_list - attribute list for On/Off cluster (client role)
-// power_config_server_attr_list - attribute list for Power COnfig cluster (server role)
-
-#define ZB_DECLARE_ZICADA_CLUSTER_LIST(			  									\
-		cluster_list_name,						      								\
-		basic_server_attr_list,														\
-		identify_client_attr_list,													\
-		identify_server_attr_list,													\
-		temperature_measurement_attr_list,											\
-		humidity_measurement_attr_list,												\
-		on_off_client_attr_list,													\
-		power_config_server_attr_list)												\
+//
+// The attribute lists named in ZB_ZICADA_CLUSTERS have to be declared before.
+
+#define ZB_DECLARE_ZICADA_CLUSTER_LIST(cluster_list_name)							\
 zb_zcl_cluster_desc_t cluster_list_name[] =											\
-{										  											\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_BASIC,													\
-		ZB_ZCL_ARRAY_SIZE(basic_server_attr_list, zb_zcl_attr_t),					\
-		(basic_server_attr_list),													\
-		ZB_ZCL_CLUSTER_SERVER_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_IDENTIFY,													\
-		ZB_ZCL_ARRAY_SIZE(identify_client_attr_list, zb_zcl_attr_t),				\
-		(identify_client_attr_list),												\
-		ZB_ZCL_CLUSTER_CLIENT_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_IDENTIFY,													\
-		ZB_ZCL_ARRAY_SIZE(identify_server_attr_list, zb_zcl_attr_t),				\
-		(identify_server_attr_list),												\
-		ZB_ZCL_CLUSTER_SERVER_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,											\
-		ZB_ZCL_ARRAY_SIZE(temperature_measurement_attr_list, zb_zcl_attr_t),		\
-		(temperature_measurement_attr_list),										\
-		ZB_ZCL_CLUSTER_SERVER_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,									\
-		ZB_ZCL_ARRAY_SIZE(humidity_measurement_attr_list, zb_zcl_attr_t),			\
-		(humidity_measurement_attr_list),											\
-		ZB_ZCL_CLUSTER_SERVER_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_ON_OFF,													\
-		ZB_ZCL_ARRAY_SIZE(on_off_client_attr_list, zb_zcl_attr_t),					\
-		(on_off_client_attr_list),													\
-		ZB_ZCL_CLUSTER_CLIENT_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	),																				\
-	ZB_ZCL_CLUSTER_DESC(															\
-		ZB_ZCL_CLUSTER_ID_POWER_CONFIG,												\
-		ZB_ZCL_ARRAY_SIZE(power_config_server_attr_list, zb_zcl_attr_t),			\
-		(power_config_server_attr_list),											\
-		ZB_ZCL_CLUSTER_SERVER_ROLE,													\
-		ZB_ZCL_MANUF_CODE_INVALID													\
-	)																				\
-}
+{																					\
+	ZB_ZICADA_CLUSTERS(ZB_ZICADA_CLUSTER_DESC)										\
+};																					\
+BUILD_ASSERT(ZB_ZCL_ARRAY_SIZE(cluster_list_name, zb_zcl_cluster_desc_t) ==			\
+	ZB_ZICADA_CLUSTER_NUM, "cluster list does not match ZB_ZICADA_CLUSTER_NUM")
 
 // Declare simple descriptor for Zicada sensor
 //
@@ -113,13 +110,8 @@ zb_zcl_cluster_desc_t cluster_list_name[] =											\
 		in_clust_num,																\
 		out_clust_num,																\
 		{																			\
-			ZB_ZCL_CLUSTER_ID_BASIC,												\
-			ZB_ZCL_CLUSTER_ID_IDENTIFY,												\
-			ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,										\
-			ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,								\
-			ZB_ZCL_CLUSTER_ID_POWER_CONFIG,											\
-			ZB_ZCL_CLUSTER_ID_IDENTIFY,												\
-			ZB_ZCL_CLUSTER_ID_ON_OFF												\
+			ZB_ZICADA_CLUSTERS(ZB_ZICADA_IN_ID)										\
+			ZB_ZICADA_CLUSTERS(ZB_ZICADA_OUT_ID)									\
 		}																			\
 	}
 
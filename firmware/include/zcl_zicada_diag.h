@@ -0,0 +1,229 @@
+#ifndef __ZCL_ZICADA_DIAG_H__
+#define __ZCL_ZICADA_DIAG_H__
+
+#include <zboss_api.h>
+
+// Zicada diagnostics cluster (manufacturer-specific cluster id range)
+//
+// Read-only attributes with device health data that is not covered by a standard
+// cluster. Values are refreshed by the application, reading them never wakes a sensor.
+
+// an enum constant like the ZBOSS cluster ids: ZB_ZCL_CLUSTER_DESC() pastes the id token to
+// find the role init function, a macro would be expanded before that when passed through
+// the cluster table in zb_zicada.h
+enum {
+	ZB_ZCL_CLUSTER_ID_ZICADA_DIAG = 0xFC00
+};
+
+#define ZB_ZCL_ZICADA_DIAG_CLUSTER_REVISION_DEFAULT ((zb_uint16_t)0x0001u)
+
+enum zb_zcl_zicada_diag_attr_e {
+	ZB_ZCL_ATTR_ZICADA_DIAG_STACK_ZBOSS_ID = 0x0000,		// bytes of the ZBOSS thread stack ever used
+	ZB_ZCL_ATTR_ZICADA_DIAG_STACK_MAIN_ID = 0x0001,			// same for the main thread
+	ZB_ZCL_ATTR_ZICADA_DIAG_STACK_LOG_ID = 0x0002,			// same for the log processing thread
+	ZB_ZCL_ATTR_ZICADA_DIAG_STACK_WORKQ_ID = 0x0003,		// same for the system workqueue
+	ZB_ZCL_ATTR_ZICADA_DIAG_HEAP_MAX_ID = 0x0004,			// largest system heap allocation total in bytes
+	ZB_ZCL_ATTR_ZICADA_DIAG_RESET_CAUSE_ID = 0x0005,		// hwinfo RESET_* flags of the last reset
+	ZB_ZCL_ATTR_ZICADA_DIAG_WDT_RESETS_ID = 0x0006,			// watchdog resets since power-on
+	ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_STATUS_ID = 0x0007,		// LFCLK_STATUS_* bits (lfclk_mgr.h)
+	ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_ACCURACY_ID = 0x0008,		// LF clock accuracy the poll interval is sized for (ppm)
+	ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_DRIFT_ID = 0x0009,		// measured LF clock drift (ppm)
+	ZB_ZCL_ATTR_ZICADA_DIAG_TIME_ERROR_ID = 0x000A,			// local time error found at the latest time sync (ms)
+	ZB_ZCL_ATTR_ZICADA_DIAG_RC_CAL_SAVED_ID = 0x000B,		// forced RC calibrations avoided since boot, estimated from the configured rates
+	ZB_ZCL_ATTR_ZICADA_DIAG_SCHED_FAILS_ID = 0x000C,		// callbacks and alarms the ZBOSS scheduler refused
+	ZB_ZCL_ATTR_ZICADA_DIAG_ALARM_FREE_ID = 0x000D,			// fewest free alarm entries seen (res_stats.h)
+	ZB_ZCL_ATTR_ZICADA_DIAG_BUF_IN_FREE_ID = 0x000E,		// fewest free in buffers seen
+	ZB_ZCL_ATTR_ZICADA_DIAG_BUF_OUT_FREE_ID = 0x000F,		// fewest free out buffers seen
+	ZB_ZCL_ATTR_ZICADA_DIAG_BUF_FAILS_ID = 0x0010,			// buffer allocations that failed
+	ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FREE_ID = 0x0011,			// fewest free bytes seen in an NVRAM page
+	ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FAILS_ID = 0x0012,		// NVRAM writes that failed
+	ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_RETRIES_ID = 0x0013,	// contact commands sent again for a missing APS ack
+	ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_DROPS_ID = 0x0014,		// contact commands given up (delivery.h)
+	ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_WRITES_ID = 0x0015,		// NVRAM writes of the application dataset
+	ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_SKIPPED_ID = 0x0016,	// dataset writes skipped, values barely changed
+	ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_ERASES_ID = 0x0017,		// NVRAM page erases since boot
+	ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_LIFETIME_ID = 0x0018,		// projected flash lifetime in days, 0xFFFF = no wear seen
+	ZB_ZCL_ATTR_ZICADA_DIAG_I2C_ACTIVE_ID = 0x0019,			// ms the I2C bus was powered since boot
+	ZB_ZCL_ATTR_ZICADA_DIAG_SAADC_ACTIVE_ID = 0x001A,		// ms the SAADC was powered since boot
+	ZB_ZCL_ATTR_ZICADA_DIAG_PM_ERRORS_ID = 0x001B,			// failed peripheral resumes and suspends
+};
+
+// attribute storage
+struct zb_zcl_zicada_diag_attrs {
+	zb_uint16_t stack_zboss;
+	zb_uint16_t stack_main;
+	zb_uint16_t stack_log;
+	zb_uint16_t stack_workq;
+	zb_uint16_t heap_max;
+	zb_uint32_t reset_cause;
+	zb_uint16_t wdt_resets;
+	zb_uint8_t lfclk_status;
+	zb_uint16_t lfclk_accuracy;
+	zb_int16_t lfclk_drift;
+	zb_int16_t time_error;
+	zb_uint32_t rc_cal_saved;
+	zb_uint16_t sched_fails;
+	zb_uint16_t alarm_free;
+	zb_uint16_t buf_in_free;
+	zb_uint16_t buf_out_free;
+	zb_uint16_t buf_fails;
+	zb_uint16_t nvram_free;
+	zb_uint16_t nvram_fails;
+	zb_uint16_t contact_retries;
+	zb_uint16_t contact_drops;
+	zb_uint16_t persist_writes;
+	zb_uint16_t persist_skipped;
+	zb_uint16_t nvram_erases;
+	zb_uint16_t nvram_lifetime;
+	zb_uint32_t i2c_active;
+	zb_uint32_t saadc_active;
+	zb_uint16_t pm_errors;
+};
+
+#define ZB_ZCL_ZICADA_DIAG_RO_U16(attr_id, data_ptr)			\
+{																\
+	attr_id,													\
+	ZB_ZCL_ATTR_TYPE_U16,										\
+	ZB_ZCL_ATTR_ACCESS_READ_ONLY,								\
+	(ZB_ZCL_NON_MANUFACTURER_SPECIFIC),							\
+	(void *) data_ptr											\
+}
+
+#define ZB_ZCL_ZICADA_DIAG_RO_S16(attr_id, data_ptr)			\
+{																\
+	attr_id,													\
+	ZB_ZCL_ATTR_TYPE_S16,										\
+	ZB_ZCL_ATTR_ACCESS_READ_ONLY,								\
+	(ZB_ZCL_NON_MANUFACTURER_SPECIFIC),							\
+	(void *) data_ptr											\
+}
+
+#define ZB_ZCL_ZICADA_DIAG_RO_U32(attr_id, data_ptr)			\
+{																\
+	attr_id,													\
+	ZB_ZCL_ATTR_TYPE_U32,										\
+	ZB_ZCL_ATTR_ACCESS_READ_ONLY,								\
+	(ZB_ZCL_NON_MANUFACTURER_SPECIFIC),							\
+	(void *) data_ptr											\
+}
+
+#define ZB_ZCL_ZICADA_DIAG_RO_MAP8(attr_id, data_ptr)			\
+{																\
+	attr_id,													\
+	ZB_ZCL_ATTR_TYPE_8BITMAP,									\
+	ZB_ZCL_ATTR_ACCESS_READ_ONLY,								\
+	(ZB_ZCL_NON_MANUFACTURER_SPECIFIC),							\
+	(void *) data_ptr											\
+}
+
+#define ZB_ZCL_ZICADA_DIAG_RO_MAP32(attr_id, data_ptr)			\
+{																\
+	attr_id,													\
+	ZB_ZCL_ATTR_TYPE_32BITMAP,									\
+	ZB_ZCL_ATTR_ACCESS_READ_ONLY,								\
+	(ZB_ZCL_NON_MANUFACTURER_SPECIFIC),							\
+	(void *) data_ptr											\
+}
+
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_STACK_ZBOSS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_ZBOSS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_STACK_MAIN_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_MAIN_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_STACK_LOG_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_LOG_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_STACK_WORKQ_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_WORKQ_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_HEAP_MAX_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_HEAP_MAX_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_RESET_CAUSE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_MAP32(ZB_ZCL_ATTR_ZICADA_DIAG_RESET_CAUSE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_WDT_RESETS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_WDT_RESETS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_STATUS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_MAP8(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_STATUS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_ACCURACY_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_ACCURACY_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_DRIFT_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_S16(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_DRIFT_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_TIME_ERROR_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_S16(ZB_ZCL_ATTR_ZICADA_DIAG_TIME_ERROR_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_RC_CAL_SAVED_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U32(ZB_ZCL_ATTR_ZICADA_DIAG_RC_CAL_SAVED_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_SCHED_FAILS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_SCHED_FAILS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_ALARM_FREE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_ALARM_FREE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_BUF_IN_FREE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_IN_FREE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_BUF_OUT_FREE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_OUT_FREE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_BUF_FAILS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_FAILS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FREE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FREE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FAILS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FAILS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_RETRIES_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_RETRIES_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_DROPS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_DROPS_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_WRITES_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_WRITES_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_SKIPPED_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_SKIPPED_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_ERASES_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_ERASES_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_LIFETIME_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_LIFETIME_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_I2C_ACTIVE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U32(ZB_ZCL_ATTR_ZICADA_DIAG_I2C_ACTIVE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_SAADC_ACTIVE_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U32(ZB_ZCL_ATTR_ZICADA_DIAG_SAADC_ACTIVE_ID, data_ptr)
+#define ZB_SET_ATTR_DESCR_WITH_ZB_ZCL_ATTR_ZICADA_DIAG_PM_ERRORS_ID(data_ptr) \
+	ZB_ZCL_ZICADA_DIAG_RO_U16(ZB_ZCL_ATTR_ZICADA_DIAG_PM_ERRORS_ID, data_ptr)
+
+// Declare attribute list for the diagnostics cluster (server)
+//
+// attr_list - attribute list variable name
+// diag - pointer to struct zb_zcl_zicada_diag_attrs
+
+#define ZB_ZCL_DECLARE_ZICADA_DIAG_ATTRIB_LIST(attr_list, diag)								\
+	ZB_ZCL_START_DECLARE_ATTRIB_LIST_CLUSTER_REVISION(attr_list, ZB_ZCL_ZICADA_DIAG)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_ZBOSS_ID, &(diag)->stack_zboss)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_MAIN_ID, &(diag)->stack_main)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_LOG_ID, &(diag)->stack_log)			\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_STACK_WORKQ_ID, &(diag)->stack_workq)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_HEAP_MAX_ID, &(diag)->heap_max)			\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_RESET_CAUSE_ID, &(diag)->reset_cause)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_WDT_RESETS_ID, &(diag)->wdt_resets)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_STATUS_ID, &(diag)->lfclk_status)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_ACCURACY_ID, &(diag)->lfclk_accuracy)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_LFCLK_DRIFT_ID, &(diag)->lfclk_drift)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_TIME_ERROR_ID, &(diag)->time_error)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_RC_CAL_SAVED_ID, &(diag)->rc_cal_saved)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_SCHED_FAILS_ID, &(diag)->sched_fails)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_ALARM_FREE_ID, &(diag)->alarm_free)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_IN_FREE_ID, &(diag)->buf_in_free)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_OUT_FREE_ID, &(diag)->buf_out_free)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_BUF_FAILS_ID, &(diag)->buf_fails)			\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FREE_ID, &(diag)->nvram_free)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_FAILS_ID, &(diag)->nvram_fails)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_RETRIES_ID, &(diag)->contact_retries)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_CONTACT_DROPS_ID, &(diag)->contact_drops)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_WRITES_ID, &(diag)->persist_writes)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_PERSIST_SKIPPED_ID, &(diag)->persist_skipped)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_ERASES_ID, &(diag)->nvram_erases)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_NVRAM_LIFETIME_ID, &(diag)->nvram_lifetime)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_I2C_ACTIVE_ID, &(diag)->i2c_active)		\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_SAADC_ACTIVE_ID, &(diag)->saadc_active)	\
+	ZB_ZCL_SET_ATTR_DESC(ZB_ZCL_ATTR_ZICADA_DIAG_PM_ERRORS_ID, &(diag)->pm_errors)			\
+	ZB_ZCL_FINISH_DECLARE_ATTRIB_LIST
+
+// cluster init, picked up by ZB_ZCL_CLUSTER_DESC()
+void zb_zcl_zicada_diag_init_server(void);
+void zb_zcl_zicada_diag_init_client(void);
+
+#define ZB_ZCL_CLUSTER_ID_ZICADA_DIAG_SERVER_ROLE_INIT zb_zcl_zicada_diag_init_server
+#define ZB_ZCL_CLUSTER_ID_ZICADA_DIAG_CLIENT_ROLE_INIT zb_zcl_zicada_diag_init_client
+
+#endif // __ZCL_ZICADA_DIAG_H__
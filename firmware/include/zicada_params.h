@@ -0,0 +1,56 @@
+#ifndef __ZICADA_PARAMS_H__
+#define __ZICADA_PARAMS_H__
+
+// Application timing and reporting parameters
+//
+// Plain defines without SDK dependencies: the host power simulator (tools/power_sim)
+// includes this header so its projections follow the firmware's schedule.
+
+// read and report battery voltage after an initial delay after joining the network 
+// then read and report battery voltage after the specified period elapses.
+#define BATTERY_CHECK_PERIOD_MSEC (1000 * 60 * 60 * 6) // 6 hours
+#define BATTERY_CHECK_INITIAL_DELAY_MSEC (1000 * 60 * 1) // 1 minute
+
+// the build variant picks the period in Kconfig (5 minutes as end device, 1 minute as router)
+#ifdef CONFIG_ZICADA_TEMP_HUMIDITY_PERIOD_SEC
+#define TEMP_HUMIDITY_CHECK_PERIOD_MSEC (1000 * CONFIG_ZICADA_TEMP_HUMIDITY_PERIOD_SEC)
+#else
+#define TEMP_HUMIDITY_CHECK_PERIOD_MSEC (1000 * 60 * 5) // 5 minutes
+#endif
+#define TEMP_HUMIDITY_CHECK_INITIAL_DELAY_MSEC (1000 * 10) // 10 seconds
+
+#define REJOIN_ATTEMPT_PERIOD_MSEC (1000 * 60 * 5) // 5 minutes
+#define REJOIN_ATTEMPT_INITIAL_DELAY_MSEC (1000 * 30) // 30 seconds
+
+// parent poll and keepalive once joined (end device only)
+#define LONG_POLL_INTERVAL_MSEC (1000 * 60 * 60) // 1 hour
+#define KEEPALIVE_TIMEOUT_MSEC (1000 * 60 * 60) // 1 hour
+
+// the parent ages the end device out after this without a poll (ED_AGING_TIMEOUT_64MIN),
+// the LF clock manager fits the poll interval into it
+#define ED_AGING_TIMEOUT_MSEC (1000 * 60 * 64) // 64 minutes
+
+// battery level (percent) below which a low battery blink follows each battery check
+#define LOW_BATTERY_LEVEL_PERCENT 10
+
+// HDC2080 measurement range in attribute units
+#define HDC2080_TEMPERATURE_MIN -4000
+#define HDC2080_TEMPERATURE_MAX 12500
+#define HDC2080_HUMIDITY_MIN 0
+#define HDC2080_HUMIDITY_MAX 10000
+
+// attribute reporting intervals in seconds, reportable change is 0 (every change is sent)
+#define RPT_MIN 0x0001
+#define RPT_MAX 0xFFFE
+
+// the contact state is also re-reported as a heartbeat, so that a restarted coordinator
+// learns it without waiting for the door to move
+#define CONTACT_RPT_MAX (60 * 60 * 4) // 4 hours
+
+// wall-clock sync with the coordinator's Time cluster, the interval starts at the minimum
+// and doubles while the drift compensated time stays accurate
+#define TIME_SYNC_MIN_INTERVAL_MSEC (1000 * 60 * 60 * 4) // 4 hours
+#define TIME_SYNC_MAX_INTERVAL_MSEC (1000 * 60 * 60 * 48) // 2 days
+#define TIME_SYNC_RETRY_MSEC (1000 * 60 * 30) // 30 minutes
+
+#endif // __ZICADA_PARAMS_H__
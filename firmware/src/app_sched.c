@@ -0,0 +1,119 @@
+// Application schedule, see app_sched.h
+//
+// Plain C without kernel dependencies so that it can also be built on a host.
+
+#include <stddef.h>
+
+#include "app_sched.h"
+#include "zicada_params.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// the parent's aging timer runs on its own clock, assume the worst allowed by 802.15.4
+#define APP_SCHED_PARENT_PPM		500
+
+// room for a poll that is delayed by CSMA retries or a busy stack
+#define APP_SCHED_POLL_GUARD_MSEC	(1000 * 60 * 2)
+
+#ifdef CONFIG_ZICADA_TIMEBASE
+#define APP_SCHED_TIME_SYNC			APP_JOB_TIME_SYNC
+#else
+#define APP_SCHED_TIME_SYNC			0
+#endif
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+uint32_t app_sched_jobs(enum app_wake wake, const struct app_state *state){
+
+	uint32_t jobs = 0;
+
+	switch (wake) {
+	case APP_WAKE_SENSOR:
+		// a due time sync goes out with this wake-up instead of waking up for it
+		jobs = APP_SCHED_TIME_SYNC;
+		// degraded mode: no sampling, contact and battery reports keep working
+		if (state->sensor_ok) jobs |= APP_JOB_SAMPLE;
+#ifdef CONFIG_ZICADA_WARM_RESTART
+		// NVRAM writes of all changes are batched into the sensor checks
+		if (state->sensor_ok && state->joined) jobs |= APP_JOB_PERSIST;
+#endif
+		break;
+	case APP_WAKE_BATTERY:
+		// the battery check also runs in degraded mode, which stops the sensor checks, so
+		// the time keeps being synced and the state keeps being written
+		jobs = APP_JOB_BATTERY | APP_SCHED_TIME_SYNC;
+#ifdef CONFIG_ZICADA_WARM_RESTART
+		if (state->joined) jobs |= APP_JOB_PERSIST;
+#endif
+		break;
+	default:
+		break;
+	}
+	return jobs;
+}
+
+uint32_t app_sched_first(enum app_wake wake, const struct app_state *state){
+
+	switch (wake) {
+	case APP_WAKE_SENSOR:
+		return TEMP_HUMIDITY_CHECK_INITIAL_DELAY_MSEC;
+	case APP_WAKE_BATTERY:
+		// resume the battery check phase instead of checking again right away
+		if (state->restored) {
+			uint32_t elapsed = state->battery_phase * TEMP_HUMIDITY_CHECK_PERIOD_MSEC;
+			if (elapsed < BATTERY_CHECK_PERIOD_MSEC - BATTERY_CHECK_INITIAL_DELAY_MSEC) {
+				return BATTERY_CHECK_PERIOD_MSEC - elapsed;
+			}
+		}
+		return BATTERY_CHECK_INITIAL_DELAY_MSEC;
+	default:
+		return 0;
+	}
+}
+
+uint32_t app_sched_next(enum app_wake wake, const struct app_state *state){
+
+	// checks stop until the next join
+	if (!state->joined) return 0;
+
+	switch (wake) {
+	case APP_WAKE_SENSOR:
+		return state->sensor_ok ? TEMP_HUMIDITY_CHECK_PERIOD_MSEC : 0;
+	case APP_WAKE_BATTERY:
+		return BATTERY_CHECK_PERIOD_MSEC;
+	default:
+		return 0;
+	}
+}
+
+uint32_t app_sched_sync_interval(uint32_t interval_ms, int32_t error_ms, uint32_t accuracy_ms){
+
+	uint32_t error = (error_ms < 0) ? -(uint32_t)error_ms : (uint32_t)error_ms;
+
+	// double while the time holds, halve when it drifted off
+	if (error <= accuracy_ms / 2) {
+		interval_ms *= 2;
+		if (interval_ms > TIME_SYNC_MAX_INTERVAL_MSEC) interval_ms = TIME_SYNC_MAX_INTERVAL_MSEC;
+	} else if (error > accuracy_ms) {
+		interval_ms /= 2;
+		if (interval_ms < TIME_SYNC_MIN_INTERVAL_MSEC) interval_ms = TIME_SYNC_MIN_INTERVAL_MSEC;
+	}
+	return interval_ms;
+}
+
+uint32_t app_sched_poll_interval(uint32_t accuracy_ppm){
+
+	// the local clock may stretch the interval, so it is shortened by the accuracy to stay
+	// within the long poll interval in real time
+	uint64_t poll = ((uint64_t)LONG_POLL_INTERVAL_MSEC * 1000000) / (1000000 + accuracy_ppm);
+
+	// and the poll has to reach the parent before it ages the device out, whose clock may
+	// shorten the timeout (only binds for a clock far off its spec)
+	uint64_t window = ((uint64_t)(ED_AGING_TIMEOUT_MSEC - APP_SCHED_POLL_GUARD_MSEC) *
+		(1000000 - APP_SCHED_PARENT_PPM)) / (1000000 + accuracy_ppm);
+	return (uint32_t)((poll < window) ? poll : window);
+}
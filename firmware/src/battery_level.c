@@ -0,0 +1,80 @@
+// NiMH cell level from its voltage, see battery_level.h
+//
+// Plain C without kernel dependencies so that it can also be built on a host.
+
+#include "battery_level.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define VC_PAIRS_COUNT (sizeof(vcPairs) / sizeof(voltage_capacity_pair_t))
+
+// Voltage - Capacity pair table from thunderboard react
+// Algorithm assumes the values are arranged in a descending order.
+// The values in the table are base on the discharge curve from lygte-info.dk:
+// https://lygte-info.dk/review/batteries2012/Ikea%20Ladda%20AA%202450mAh%20%28White%29%20UK.html
+// Table modified for zigbee half percent steps.
+static const voltage_capacity_pair_t vcPairs[] =
+{ { 1450, 100 }, { 1350, 92 }, { 1300, 78 }, { 1250, 24 }, { 1220, 13 },
+  { 1160, 5 }, { 1100, 2 }, { 900, 0 } };
+
+//---------------------------------------------------------------------------------------------
+// Calculate battery level based on the cell voltage (from thunderboard react)
+//
+
+uint8_t NiMH_CalculateLevel (uint16_t voltage){
+
+  uint32_t res = 0;
+  uint8_t i;
+
+  // Iterate through voltage/capacity table until correct interval is found.
+  // Then interpolate capacity within that interval based on a linear approximation
+  // between the capacity at the low and high end of the interval.
+  for (i = 0; i < VC_PAIRS_COUNT; i++) {
+    if (voltage > vcPairs[i].voltage) {
+      if (i == 0) {
+        // Higher than maximum voltage in table.
+        return vcPairs[0].capacity;
+      } else {
+        // Calculate the capacity by interpolation.
+        res = (voltage - vcPairs[i].voltage)
+              * (vcPairs[i - 1].capacity - vcPairs[i].capacity)
+              / (vcPairs[i - 1].voltage - vcPairs[i].voltage);
+        res += vcPairs[i].capacity;
+        return (uint8_t)res;
+      }
+    }
+  }
+  // Below the minimum voltage in the table.
+  return vcPairs[VC_PAIRS_COUNT - 1].capacity;
+}
+
+//---------------------------------------------------------------------------------------------
+// Cell voltage at a remaining capacity, the same curve the other way round
+//
+
+uint16_t NiMH_CalculateVoltage (uint16_t level_permille){
+
+  uint32_t res = 0;
+  uint8_t i;
+
+  for (i = 0; i < VC_PAIRS_COUNT; i++) {
+    uint32_t capacity = vcPairs[i].capacity * 10u;
+    if (level_permille > capacity) {
+      if (i == 0) {
+        // Fuller than the table.
+        return vcPairs[0].voltage;
+      } else {
+        // Calculate the voltage by interpolation.
+        res = (level_permille - capacity)
+              * (uint32_t)(vcPairs[i - 1].voltage - vcPairs[i].voltage)
+              / (vcPairs[i - 1].capacity * 10u - capacity);
+        res += vcPairs[i].voltage;
+        return (uint16_t)res;
+      }
+    }
+  }
+  // Empty.
+  return vcPairs[VC_PAIRS_COUNT - 1].voltage;
+}
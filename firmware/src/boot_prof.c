@@ -0,0 +1,50 @@
+// Boot phase timestamps, see boot_prof.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "boot_prof.h"
+#include "evt_log.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static uint32_t phase_ms[BOOT_PHASE_COUNT];
+static uint32_t phases_done;
+
+static const char *const phase_names[BOOT_PHASE_COUNT] = {
+	[BOOT_PHASE_MAIN]			= "main",
+	[BOOT_PHASE_GPIO]			= "gpio",
+	[BOOT_PHASE_STACK_ENABLED]	= "stack enabled",
+	[BOOT_PHASE_SENSOR_READY]	= "sensor ready",
+	[BOOT_PHASE_STACK_STARTED]	= "stack started",
+	[BOOT_PHASE_JOINED]			= "joined",
+	[BOOT_PHASE_FIRST_SLEEP]	= "first sleep",
+	[BOOT_PHASE_FIRST_REPORT]	= "first report",
+};
+
+//---------------------------------------------------------------------------------------------
+// record a boot phase
+//
+
+void boot_phase_mark(enum boot_phase phase){
+
+	if (phase >= BOOT_PHASE_COUNT) return;
+
+	unsigned int key = irq_lock();
+	bool first = !(phases_done & BIT(phase));
+	if (first) {
+		phases_done |= BIT(phase);
+		// never store 0, that means "not reached"
+		phase_ms[phase] = MAX(k_uptime_get_32(), 1);
+	}
+	irq_unlock(key);
+
+	if (!first) return;
+
+	evt_log_put(EVT_BOOT_PHASE, phase, phase_ms[phase]);
+	LOG_INF("Boot phase %s: %u ms", phase_names[phase], phase_ms[phase]);
+}
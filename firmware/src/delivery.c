@@ -0,0 +1,191 @@
+// Delivery policy per message class, see delivery.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zboss_api.h>
+
+#include "delivery.h"
+#include "evt_log.h"
+#include "res_stats.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define DELIVERY_RETRY_MSEC		CONFIG_ZICADA_DELIVERY_RETRY_MS
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+struct delivery_slot {
+	delivery_send_t send;
+	zb_uint16_t arg;
+	uint8_t attempt;		// retries done for the current message
+	bool active;			// a message is not yet confirmed or dropped
+	bool in_flight;			// a frame waits for its buffer or its confirm
+	bool queued;			// a newer message waits for the confirm of the frame in flight
+};
+
+#define DELIVERY_NAME(id, name, retries) [id] = name,
+#define DELIVERY_RETRIES(id, name, retries) [id] = retries,
+
+static const char *const class_names[DELIVERY_CLASS_COUNT] = {
+	DELIVERY_CLASSES(DELIVERY_NAME)
+};
+
+static const uint8_t class_retries[DELIVERY_CLASS_COUNT] = {
+	DELIVERY_CLASSES(DELIVERY_RETRIES)
+};
+
+static struct delivery_slot slots[DELIVERY_CLASS_COUNT];
+static struct delivery_stats stats;
+
+static void delivery_transmit(zb_bufid_t bufid, zb_uint16_t cls);
+static void delivery_confirm(enum delivery_class cls, zb_bufid_t bufid);
+static zb_ret_t delivery_failed(enum delivery_class cls, zb_ret_t status);
+
+// the send callback only gets the buffer, one per class tells them apart
+#define DELIVERY_CONFIRM_FN(id, name, retries)									\
+	static void id##_confirm(zb_bufid_t bufid) { delivery_confirm(id, bufid); }
+#define DELIVERY_CONFIRM_REF(id, name, retries) [id] = id##_confirm,
+
+DELIVERY_CLASSES(DELIVERY_CONFIRM_FN)
+
+static const zb_callback_t confirm_fns[DELIVERY_CLASS_COUNT] = {
+	DELIVERY_CLASSES(DELIVERY_CONFIRM_REF)
+};
+
+//---------------------------------------------------------------------------------------------
+// send the message of a class, a buffer is taken first. Without a buffer the message is
+// retried like an unacknowledged one, the error is returned once it is dropped.
+//
+
+static zb_ret_t delivery_start(enum delivery_class cls){
+
+	slots[cls].in_flight = true;
+
+	zb_ret_t err = zb_buf_get_out_delayed_ext(delivery_transmit, cls, 0);
+	if (err) {
+		LOG_ERR("No buffer for a %s message: %d", class_names[cls], err);
+		res_stats_fail(RES_STATS_BUF_OUT);
+		slots[cls].in_flight = false;
+		return delivery_failed(cls, err);
+	}
+	return RET_OK;
+}
+
+static void delivery_transmit(zb_bufid_t bufid, zb_uint16_t cls){
+
+	struct delivery_slot *slot = &slots[cls];
+
+	// the frame carries the latest message, also one that came while waiting for the buffer
+	slot->queued = false;
+	slot->send(bufid, slot->arg, confirm_fns[cls]);
+}
+
+static void delivery_retry(zb_uint8_t cls){
+
+	// a newer message may have been sent meanwhile, then this retry is obsolete
+	if (slots[cls].active && !slots[cls].in_flight) delivery_start(cls);
+}
+
+//---------------------------------------------------------------------------------------------
+// confirm of a frame, status of the APS acknowledgement
+//
+
+static void delivery_confirm(enum delivery_class cls, zb_bufid_t bufid){
+
+	struct delivery_slot *slot = &slots[cls];
+	zb_zcl_command_send_status_t *send_status = ZB_BUF_GET_PARAM(bufid, zb_zcl_command_send_status_t);
+	zb_ret_t status = send_status->status;
+
+	zb_buf_free(bufid);
+	slot->in_flight = false;
+
+	if (slot->queued) {
+		// the frame carried an older message, whatever happened to it the newer one goes out
+		slot->queued = false;
+		delivery_start(cls);
+		return;
+	}
+
+	if (status == RET_OK) {
+		slot->active = false;
+		stats.confirmed[cls]++;
+		return;
+	}
+
+	delivery_failed(cls, status);
+}
+
+//---------------------------------------------------------------------------------------------
+// a frame failed or found no buffer: schedule a retry, or drop the message after the last one.
+// Returns the status if the message was dropped.
+//
+
+static zb_ret_t delivery_failed(enum delivery_class cls, zb_ret_t status){
+
+	struct delivery_slot *slot = &slots[cls];
+
+	if (slot->attempt >= class_retries[cls]) {
+		LOG_WRN("Dropped a %s message after %u retries: %d", class_names[cls], slot->attempt, status);
+		evt_log_put(EVT_DELIVERY_DROPPED, cls, slot->arg);
+		slot->active = false;
+		stats.dropped[cls]++;
+		return status;
+	}
+
+	uint32_t delay = DELIVERY_RETRY_MSEC << slot->attempt;
+	slot->attempt++;
+	stats.retries[cls]++;
+	LOG_DBG("Retrying a %s message in %u ms", class_names[cls], delay);
+
+	zb_ret_t err = ZB_SCHEDULE_APP_ALARM(delivery_retry, cls, ZB_MILLISECONDS_TO_BEACON_INTERVAL(delay));
+	if (err) {
+		LOG_ERR("Failed to schedule a %s retry: %d", class_names[cls], err);
+		evt_log_put(EVT_ALARM_FAILED, err, (int32_t)(uintptr_t)delivery_retry);
+		res_stats_fail(RES_STATS_ALARM);
+		evt_log_put(EVT_DELIVERY_DROPPED, cls, slot->arg);
+		slot->active = false;
+		stats.dropped[cls]++;
+		return err;
+	}
+	return RET_OK;
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+zb_ret_t delivery_send(enum delivery_class cls, delivery_send_t send, zb_uint16_t arg){
+
+	struct delivery_slot *slot = &slots[cls];
+
+	if (slot->active) {
+		stats.superseded[cls]++;
+	}
+	stats.sent[cls]++;
+
+	slot->send = send;
+	slot->arg = arg;
+	slot->attempt = 0;
+	slot->active = true;
+
+	if (slot->in_flight) {
+		// one frame per class at a time, this one goes out with the confirm of the old one
+		slot->queued = true;
+		return RET_OK;
+	}
+
+	ZB_SCHEDULE_APP_ALARM_CANCEL(delivery_retry, cls);
+	return delivery_start(cls);
+}
+
+const struct delivery_stats *delivery_get(void){
+
+	return &stats;
+}
@@ -0,0 +1,97 @@
+// Binary event log in retained RAM, see evt_log.h
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "evt_log.h"
+#include "retained.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define EVT_LOG_MAGIC		0x5A45564CUL	// "ZEVL"
+#define EVT_LOG_SIZE		CONFIG_ZICADA_EVT_LOG_SIZE
+#define EVT_LOG_MASK		(EVT_LOG_SIZE - 1)
+
+BUILD_ASSERT((EVT_LOG_SIZE & EVT_LOG_MASK) == 0, "CONFIG_ZICADA_EVT_LOG_SIZE must be a power of two");
+BUILD_ASSERT(sizeof(struct evt_log_rec) == 12, "event log records must stay 12 bytes for the host decoder");
+
+//---------------------------------------------------------------------------------------------
+// typedefs
+//
+
+// ring buffer kept in noinit RAM so that it survives warm resets (watchdog, fault, pin reset)
+struct evt_log_ring {
+	uint32_t magic;
+	uint32_t head;			// number of records ever written, index = head & EVT_LOG_MASK
+	uint32_t boots;			// number of boots since the ring was last initialized
+	struct evt_log_rec rec[EVT_LOG_SIZE];
+};
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static __zicada_retained struct evt_log_ring ring;
+
+//---------------------------------------------------------------------------------------------
+// validate the ring after a reset and record the boot event
+//
+
+void evt_log_init(uint16_t reset_cause){
+
+	// after a power-on reset the RAM content is random, start over
+	if (ring.magic != EVT_LOG_MAGIC) {
+		memset(&ring, 0, sizeof(ring));
+		ring.magic = EVT_LOG_MAGIC;
+	}
+
+	ring.boots++;
+	evt_log_put(EVT_BOOT, reset_cause, ring.boots);
+}
+
+//---------------------------------------------------------------------------------------------
+// append a record
+//
+
+void evt_log_put(enum evt_log_id id, int16_t arg0, int32_t arg1){
+
+	unsigned int key = irq_lock();
+	struct evt_log_rec *rec = &ring.rec[ring.head & EVT_LOG_MASK];
+
+	rec->timestamp = k_uptime_get_32();
+	rec->id = id;
+	rec->arg0 = arg0;
+	rec->arg1 = arg1;
+	ring.head++;
+
+	irq_unlock(key);
+}
+
+//---------------------------------------------------------------------------------------------
+// dump the ring over the console, oldest record first
+//
+// Output format (parsed by tools/evt_log_decode.py):
+//   EVL <head> <boots> <count>
+//   EVR <24 hex digits, record bytes in memory order>
+//
+
+void evt_log_dump(void){
+
+	uint32_t head = ring.head;
+	uint32_t count = MIN(head, EVT_LOG_SIZE);
+
+	printk("EVL %u %u %u\n", head, ring.boots, count);
+
+	for (uint32_t i = head - count; i != head; i++) {
+		const uint8_t *p = (const uint8_t *)&ring.rec[i & EVT_LOG_MASK];
+
+		printk("EVR ");
+		for (size_t j = 0; j < sizeof(struct evt_log_rec); j++) {
+			printk("%02x", p[j]);
+		}
+		printk("\n");
+	}
+}
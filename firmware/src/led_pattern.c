@@ -0,0 +1,160 @@
+// LED pattern engine on the PWM peripheral, see led_pattern.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <soc.h>
+#include <dk_buttons_and_leds.h>
+#include <drivers/include/nrfx_pwm.h>
+
+#include "led_pattern.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// dk library index and devicetree node of the network state LED (P0.08 or P1.04 on rev1)
+#define LED_INDEX			0
+#define LED_NODE			DT_ALIAS(led0)
+#define LED_PIN				NRF_DT_GPIOS_TO_PSEL(LED_NODE, gpios)
+#define LED_ACTIVE_LOW		(DT_GPIO_FLAGS(LED_NODE, gpios) & GPIO_ACTIVE_LOW)
+
+// one PWM period per pattern step: 12500 counts at 125 kHz = 100 ms
+#define LED_STEP_TOP		12500
+
+// compare values for a constantly active / inactive output, bit 15 selects the polarity
+#define LED_POLARITY		(LED_ACTIVE_LOW ? 0 : 0x8000)
+#define LED_VALUE_ON		(LED_POLARITY | 0x7FFF)
+#define LED_VALUE_OFF		(LED_POLARITY | 0)
+
+#define LED_MAX_STEPS		16
+
+//---------------------------------------------------------------------------------------------
+// typedefs
+//
+
+struct led_pattern_def {
+	const uint8_t *steps;	// 1: on, 0: off, one entry per 100 ms
+	uint8_t len;
+	bool loop;				// repeat until stopped, otherwise end in the base state
+};
+
+//---------------------------------------------------------------------------------------------
+// pattern table
+//
+
+static const uint8_t identify_steps[]		= { 1, 0 };
+static const uint8_t joining_steps[]		= { 1, 0, 1, 0, 1, 0 };
+static const uint8_t contact_steps[]		= { 1, 1, 1, 1, 1 };
+static const uint8_t low_battery_steps[]	= { 1, 0, 0, 1, 0, 0 };
+static const uint8_t factory_reset_steps[]	= { 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+#define LED_PATTERN(name, is_loop) { name, ARRAY_SIZE(name), is_loop }
+
+static const struct led_pattern_def patterns[LED_PATTERN_COUNT] = {
+	[LED_PATTERN_IDENTIFY]		= LED_PATTERN(identify_steps, true),
+	[LED_PATTERN_JOINING]		= LED_PATTERN(joining_steps, false),
+	[LED_PATTERN_CONTACT]		= LED_PATTERN(contact_steps, false),
+	[LED_PATTERN_LOW_BATTERY]	= LED_PATTERN(low_battery_steps, false),
+	[LED_PATTERN_FACTORY_RESET]	= LED_PATTERN(factory_reset_steps, false),
+};
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static const nrfx_pwm_t pwm = NRFX_PWM_INSTANCE(0);
+
+// EasyDMA reads the sequence from RAM while it plays, so alternate between two buffers
+static nrf_pwm_values_common_t seq_values[2][LED_MAX_STEPS + 1];
+static uint8_t seq_buf;
+
+static bool initialized;
+static bool base_on;
+static bool loop_active;
+
+//---------------------------------------------------------------------------------------------
+// start playback of a sequence of steps, no interrupts are used
+//
+
+static void play_steps(const uint8_t *steps, uint8_t len, bool loop){
+
+	nrf_pwm_values_common_t *values = seq_values[seq_buf];
+	uint8_t n = 0;
+
+	seq_buf ^= 1;
+
+	for (uint8_t i = 0; (i < len) && (n < LED_MAX_STEPS); i++) {
+		values[n++] = steps[i] ? LED_VALUE_ON : LED_VALUE_OFF;
+	}
+
+	// one-shot patterns end in the base state, the PWM stops itself after the last step
+	if (!loop) values[n++] = base_on ? LED_VALUE_ON : LED_VALUE_OFF;
+
+	nrf_pwm_sequence_t seq = {
+		.values.p_common = values,
+		.length = n,
+		.repeats = 0,
+		.end_delay = 0,
+	};
+
+	loop_active = loop;
+	nrfx_pwm_simple_playback(&pwm, &seq, 1, loop ? NRFX_PWM_FLAG_LOOP : NRFX_PWM_FLAG_STOP);
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+int led_pattern_init(void){
+
+	nrfx_pwm_config_t config = NRFX_PWM_DEFAULT_CONFIG(LED_PIN,
+		NRF_PWM_PIN_NOT_CONNECTED, NRF_PWM_PIN_NOT_CONNECTED, NRF_PWM_PIN_NOT_CONNECTED);
+
+	config.base_clock = NRF_PWM_CLK_125kHz;
+	config.count_mode = NRF_PWM_MODE_UP;
+	config.top_value = LED_STEP_TOP;
+	config.load_mode = NRF_PWM_LOAD_COMMON;
+	config.step_mode = NRF_PWM_STEP_AUTO;
+
+	// no event handler: sequences start and stop in hardware
+	nrfx_err_t err = nrfx_pwm_init(&pwm, &config, NULL, NULL);
+	if (err != NRFX_SUCCESS) {
+		LOG_ERR("Cannot init LED PWM (err: 0x%x)", err);
+		return -EIO;
+	}
+
+	initialized = true;
+	return 0;
+}
+
+void led_pattern_set_base(bool on){
+
+	base_on = on;
+
+	// the GPIO output register holds the level whenever the PWM does not drive the pin
+	dk_set_led(LED_INDEX, on);
+
+	if (!initialized) return;
+
+	// an identify loop keeps playing, it returns to the new base state when stopped
+	if (!loop_active) led_pattern_stop();
+}
+
+void led_pattern_play(enum led_pattern pattern){
+
+	if (!initialized || (pattern >= LED_PATTERN_COUNT)) return;
+
+	play_steps(patterns[pattern].steps, patterns[pattern].len, patterns[pattern].loop);
+}
+
+void led_pattern_stop(void){
+
+	if (!initialized) return;
+
+	// a single step in the base state, then the PWM stops
+	play_steps(NULL, 0, false);
+}
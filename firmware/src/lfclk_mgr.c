@@ -0,0 +1,142 @@
+// LF clock manager, see lfclk_mgr.h
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <hal/nrf_clock.h>
+
+#include "lfclk_mgr.h"
+#include "evt_log.h"
+#include "timebase.h"
+#include "app_sched.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// the LFXO typically starts in 0.25 s, a crystal that needs longer than this is not usable
+#define LFCLK_PROBE_TIMEOUT_US		(1000 * 1000)
+#define LFCLK_PROBE_STEP_US			1000
+
+// accuracy of the source until the drift is measured
+#ifdef CONFIG_CLOCK_CONTROL_NRF_ACCURACY
+#define LFCLK_SPEC_PPM				CONFIG_CLOCK_CONTROL_NRF_ACCURACY
+#else
+#define LFCLK_SPEC_PPM				500
+#endif
+
+// the measured drift is an average, a calibrated RC oscillator wanders around it with the
+// temperature between calibrations
+#define LFCLK_WANDER_PPM			100
+
+#if defined(CONFIG_CLOCK_CONTROL_NRF_K32SRC_RC) && defined(CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_PERIOD)
+// MPSL checks the temperature every calibration period and calibrates when it changed or
+// after MAX_SKIP checks without a change. The SDK defaults (4 s, 1) force a calibration,
+// and with it an HFXO start, every 8 s even at a constant temperature.
+#define LFCLK_SDK_FORCED_CAL_MSEC	(4000 * (1 + 1))
+#define LFCLK_FORCED_CAL_MSEC		(CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_PERIOD *	\
+										(CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_MAX_SKIP + 1))
+#endif
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static struct lfclk_stats stats;
+
+//---------------------------------------------------------------------------------------------
+// crystal probe, runs before the clock control driver and MPSL start the LF clock
+//
+
+static int lfclk_probe(void){
+
+	// after some resets the clock is still running (e.g. forced on by the watchdog), it
+	// must not be stopped under the RTC then
+	if (nrf_clock_lf_is_running(NRF_CLOCK)) return 0;
+
+	nrf_clock_lf_src_set(NRF_CLOCK, NRF_CLOCK_LFCLK_XTAL);
+	nrf_clock_event_clear(NRF_CLOCK, NRF_CLOCK_EVENT_LFCLKSTARTED);
+	nrf_clock_task_trigger(NRF_CLOCK, NRF_CLOCK_TASK_LFCLKSTART);
+
+	bool started = false;
+	for (uint32_t t = 0; t < LFCLK_PROBE_TIMEOUT_US; t += LFCLK_PROBE_STEP_US) {
+		if (nrf_clock_event_check(NRF_CLOCK, NRF_CLOCK_EVENT_LFCLKSTARTED)) {
+			started = true;
+			break;
+		}
+		k_busy_wait(LFCLK_PROBE_STEP_US);
+	}
+
+	// leave the clock stopped for the driver, which sets its own source
+	nrf_clock_task_trigger(NRF_CLOCK, NRF_CLOCK_TASK_LFCLKSTOP);
+	while (nrf_clock_lf_is_running(NRF_CLOCK)) {
+	}
+	nrf_clock_event_clear(NRF_CLOCK, NRF_CLOCK_EVENT_LFCLKSTARTED);
+
+	stats.status |= LFCLK_STATUS_PROBED;
+	if (started) stats.status |= LFCLK_STATUS_XTAL_FITTED;
+	return 0;
+}
+
+SYS_INIT(lfclk_probe, PRE_KERNEL_1, 0);
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void lfclk_mgr_init(void){
+
+	bool xtal_build = !IS_ENABLED(CONFIG_CLOCK_CONTROL_NRF_K32SRC_RC);
+	bool fitted = stats.status & LFCLK_STATUS_XTAL_FITTED;
+
+	if (xtal_build) stats.status |= LFCLK_STATUS_XTAL_BUILD;
+
+	if (!(stats.status & LFCLK_STATUS_PROBED)) {
+		LOG_INF("LF clock already running, crystal probe skipped");
+	} else if (xtal_build && !fitted) {
+		// the source is fixed when MPSL is built, the fix is a build with the RC options
+		stats.status |= LFCLK_STATUS_MISMATCH;
+		LOG_ERR("No 32 kHz crystal fitted, build with CONFIG_CLOCK_CONTROL_NRF_K32SRC_RC=y");
+	} else if (!xtal_build && fitted) {
+		stats.status |= LFCLK_STATUS_MISMATCH;
+		LOG_WRN("32 kHz crystal fitted but unused, a crystal build saves the RC calibration");
+	}
+	evt_log_put(EVT_LFCLK_PROBE, stats.status, LFCLK_SPEC_PPM);
+
+	lfclk_mgr_update();
+}
+
+uint32_t lfclk_mgr_update(void){
+
+	int32_t drift, error;
+	uint32_t ppm = LFCLK_SPEC_PPM;
+
+	if (timebase_drift(&drift, &error)) {
+		stats.status |= LFCLK_STATUS_MEASURED;
+		stats.drift_ppm = (int16_t)CLAMP(drift, INT16_MIN, INT16_MAX);
+		stats.time_error_ms = (int16_t)CLAMP(error, INT16_MIN, INT16_MAX);
+		ppm = abs(drift) + LFCLK_WANDER_PPM;
+	}
+	stats.accuracy_ppm = (uint16_t)MIN(ppm, UINT16_MAX);
+
+	stats.poll_interval_ms = app_sched_poll_interval(ppm);
+
+#ifdef LFCLK_FORCED_CAL_MSEC
+	// estimate from the configured calibration rates, MPSL does not count its calibrations
+	uint64_t uptime = k_uptime_get();
+	uint64_t saved = uptime / LFCLK_SDK_FORCED_CAL_MSEC - uptime / LFCLK_FORCED_CAL_MSEC;
+	stats.cal_saved = (uint32_t)MIN(saved, UINT32_MAX);
+#endif
+
+	LOG_INF("LF clock: accuracy %u ppm%s, poll interval %u s", stats.accuracy_ppm,
+		(stats.status & LFCLK_STATUS_MEASURED) ? " (measured)" : "", stats.poll_interval_ms / 1000);
+	return stats.poll_interval_ms;
+}
+
+const struct lfclk_stats *lfclk_mgr_get(void){
+
+	return &stats;
+}
@@ -10,6 +10,7 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/hwinfo.h>
 #include <dk_buttons_and_leds.h>
 #include <ram_pwrdn.h>
 #include <drivers/include/nrfx_saadc.h>
@@ -21,8 +22,25 @@
 #include <zigbee/zigbee_error_handler.h>
 #include <zb_nrf_platform.h>
 #include <zb_zcl_rel_humidity_measurement.h>
+#include <zb_zcl_binary_input.h>
 #include "zb_mem_config_custom.h"
 #include "zb_zicada.h"
+#include "evt_log.h"
+#include "persist.h"
+#include "boot_prof.h"
+#include "periph_pm.h"
+#include "led_pattern.h"
+#include "sensor_filter.h"
+#include "app_sched.h"
+#include "battery_level.h"
+#include "zicada_params.h"
+#include "zcl_zicada_diag.h"
+#include "mem_stats.h"
+#include "wdt_sup.h"
+#include "timebase.h"
+#include "lfclk_mgr.h"
+#include "res_stats.h"
+#include "delivery.h"
 
 //---------------------------------------------------------------------------------------------
 // defines
@@ -38,7 +56,11 @@
 #define ZICADA_INIT_BASIC_MANUF_NAME		"kernm.de"							// Manufacturer name (32 bytes).
 #define ZICADA_INIT_BASIC_MODEL_ID			"Zicada"							// Model number assigned by the manufacturer (32-bytes long string).
 #define ZICADA_INIT_BASIC_DATE_CODE			"20250801"							// Date provided by the manufacturer of the device in ISO 8601 format (YYYYMMDD), for the first 8 bytes. The remaining 8 bytes are manufacturer-specific.
+#if defined(CONFIG_ZIGBEE_ROLE_ROUTER)
+#define ZICADA_INIT_BASIC_POWER_SOURCE		ZB_ZCL_BASIC_POWER_SOURCE_DC_SOURCE	// Type of power source or sources available for the device. For possible values, see section 3.2.2.2.8 of the ZCL specification.
+#else
 #define ZICADA_INIT_BASIC_POWER_SOURCE		ZB_ZCL_BASIC_POWER_SOURCE_BATTERY	// Type of power source or sources available for the device. For possible values, see section 3.2.2.2.8 of the ZCL specification.
+#endif
 #define ZICADA_INIT_BASIC_LOCATION_DESC		"Home"								// Description of the physical location of the device (16 bytes). You can modify it during the commisioning process.
 #define ZICADA_INIT_BASIC_PH_ENV			ZB_ZCL_BASIC_ENV_UNSPECIFIED		// Description of the type of physical environment. For possible values, see section 3.2.2.2.10 of the ZCL specification.
 
@@ -54,8 +76,8 @@
 // for all network devices before running other samples.
 #define ERASE_PERSISTENT_CONFIG    ZB_FALSE
 
-// LED
-#define ZIGBEE_NETWORK_STATE_LED   0      // on: disconnected, blinking: identify, off: normal operation
+// LED (driven by the pattern engine in led_pattern.c)
+// on: disconnected, blinking: identify, off: normal operation
 
 // Button
 #define BUTTON_0				BIT(0) // short press: identify, long press: factory reset
@@ -66,18 +88,7 @@ static const struct gpio_dt_spec hall_sensor = GPIO_DT_SPEC_GET(DT_NODELABEL(hal
 // Temperature and humidity sensor
 const struct device *const hdc20 = DEVICE_DT_GET_ONE(ti_hdc2080);
 
-// read and report battery voltage after an initial delay after joining the network 
-// then read and report battery voltage after the specified period elapses.
-#define BATTERY_CHECK_PERIOD_MSEC (1000 * 60 * 60 * 6) // 6 hours
-#define BATTERY_CHECK_INITIAL_DELAY_MSEC (1000 * 60 * 1) // 1 minute
-
-#define TEMP_HUMIDITY_CHECK_PERIOD_MSEC (1000 * 60 * 5) // 5 minutes
-#define TEMP_HUMIDITY_CHECK_INITIAL_DELAY_MSEC (1000 * 10) // 10 seconds
-
-#define REJOIN_ATTEMPT_PERIOD_MSEC (1000 * 60 * 5) // 5 minutes
-#define REJOIN_ATTEMPT_INITIAL_DELAY_MSEC (1000 * 30) // 30 seconds
-
-#define CONTACT_LED_INDICATION_DURATION_MSEC 500  // 500ms LED flash
+// check, poll and reporting intervals are in zicada_params.h
 
 // Zigbee Cluster Library 4.4.2.2.1.1: MeasuredValue = 100x temperature in degrees Celsius */
 #define ZCL_TEMPERATURE_MEASUREMENT_MEASURED_VALUE_MULTIPLIER 100
@@ -105,6 +116,13 @@ struct zb_zcl_humidity_measurement_attrs_t
 	zb_int16_t max_measure_value;
 };
 
+// attribute storage for the contact state (Binary Input, present value = contact closed)
+struct zb_zcl_binary_input_attrs {
+	zb_bool_t out_of_service;
+	zb_bool_t present_value;
+	zb_uint8_t status_flags;
+};
+
 // attribute storage for our device
 struct zb_device_ctx {
 	zb_zcl_basic_attrs_ext_t basic_attr;
@@ -113,6 +131,8 @@ struct zb_device_ctx {
 	struct zb_zcl_humidity_measurement_attrs_t humidity_attrs;
 	zb_zcl_on_off_attrs_t on_off_attrs;
 	zb_zcl_power_attrs_t power_attr;
+	struct zb_zcl_zicada_diag_attrs diag_attrs;
+	struct zb_zcl_binary_input_attrs contact_attrs;
 };
 
 // storage for the destination short address and endpoint number
@@ -121,12 +141,6 @@ struct dest_context {
 	zb_uint16_t short_addr;
 };
 
-// coin cell voltage-capacity pairs
-typedef struct {
-  uint16_t      voltage;
-  uint8_t       capacity;
-} voltage_capacity_pair_t;
-
 // Add an attribute storage struct for On/Off server
 struct zb_zcl_on_off_attrs {
     zb_bool_t on_off;
@@ -142,18 +156,33 @@ zb_zcl_reporting_info_t *zb_zcl_get_reporting_info(zb_uint8_t slot_number);
 void zboss_signal_handler (zb_bufid_t bufid);
 static void configure_gpio (void);
 static void button_handler (uint32_t button_state, uint32_t has_changed);
-static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id);
+static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id, zb_callback_t confirm);
+static void contact_send_direct (zb_bufid_t bufid, zb_uint16_t cmd_id, zb_callback_t confirm);
+#ifdef CONFIG_ZICADA_BINDING
+static void bind_coordinator (zb_bufid_t bufid);
+#endif
 static void start_identifying (zb_bufid_t bufid);
+#ifdef CONFIG_ZICADA_FB_INITIATOR
+static zb_bool_t finding_binding_cb (zb_int16_t status, zb_ieee_addr_t addr, zb_uint8_t ep, zb_uint16_t cluster);
+#endif
 static void identify_cb (zb_bufid_t bufid);
-static void toggle_identify_led (zb_bufid_t bufid);
+static zb_uint8_t zcl_ep_handler (zb_bufid_t bufid);
 static void app_clusters_attr_init (void);
 static void check_battery_level(zb_bufid_t bufid);
-static uint8_t NiMH_CalculateLevel (uint16_t voltage);
 static void configure_attribute_reporting (void);
 static void check_hall_sensor_and_send_command(zb_bufid_t bufid);
 static void hall_sensor_interrupt_callback(const struct device *dev, struct gpio_callback *cb, uint32_t pins);
 static void attempt_rejoin(zb_bufid_t bufid);
-static void turn_off_led(zb_bufid_t bufid);
+static void show_factory_reset (zb_bufid_t bufid);
+static void restore_persisted_state (void);
+static void init_temp_humidity_sensor (void);
+static void apply_initial_sample (zb_bufid_t bufid);
+static int sample_temp_humidity (int32_t *temperature, int32_t *humidity);
+static void schedule_temp_humidity_check (void);
+static void app_state_get (struct app_state *state);
+static void update_diag_attributes (void);
+static void update_poll_interval (void);
+static void restore_reported_value (zb_uint16_t cluster_id, zb_uint16_t attr_id, zb_uint16_t value);
 
 //---------------------------------------------------------------------------------------------
 // Globals
@@ -170,6 +199,16 @@ static struct dest_context dest_ctx;
 // Global variable to track current hall sensor state
 static bool current_hall_state = false;
 
+// contact state the last On/Off command was sent for
+static bool sent_hall_state = false;
+
+// set if the reset did not remove power and the persisted state can be trusted
+static bool warm_restart = false;
+
+// cleared if the HDC2080 failed to come up: the device keeps running without
+// temperature & humidity (degraded mode)
+static bool sensor_ok = false;
+
 // Attributes setup
 ZB_ZCL_DECLARE_BASIC_ATTRIB_LIST_EXT(
 	basic_server_attr_list, 
@@ -240,16 +279,27 @@ ZB_ZCL_DECLARE_POWER_CONFIG_BATTERY_ATTRIB_LIST_EXT(
     /*battery_percentage_threshold3=*/NULL,
     /*battery_alarm_state=*/NULL);
 
-// Cluster setup
+// Declare attribute list for the Zicada diagnostics cluster (server).
+ZB_ZCL_DECLARE_ZICADA_DIAG_ATTRIB_LIST(
+	diag_server_attr_list,
+	&dev_ctx.diag_attrs
+);
+
+// Declare attribute list for Binary Input (server), reports the contact state.
+ZB_ZCL_DECLARE_BINARY_INPUT_ATTRIB_LIST(
+	binary_input_server_attr_list,
+	&dev_ctx.contact_attrs.out_of_service,
+	&dev_ctx.contact_attrs.present_value,
+	&dev_ctx.contact_attrs.status_flags
+);
+
+// Declare attribute list for Time cluster (client), used to read the coordinator's time.
+ZB_ZCL_START_DECLARE_ATTRIB_LIST(time_client_attr_list)
+ZB_ZCL_FINISH_DECLARE_ATTRIB_LIST;
+
+// Cluster setup (clusters and attribute lists are listed in ZB_ZICADA_CLUSTERS)
 ZB_DECLARE_ZICADA_CLUSTER_LIST(
-	zicada_clusters, 
-	basic_server_attr_list,
-	identify_client_attr_list, 
-	identify_server_attr_list,
-	temperature_measurement_attr_list,
-	humidity_measurement_attr_list,
-	on_off_client_attr_list,
-	power_config_server_attr_list
+	zicada_clusters
 );
 
 // Declare endpoint
@@ -266,17 +316,28 @@ ZBOSS_DECLARE_DEVICE_CTX_1_EP(
 );
 
 // This allows for the initial values to be set correctly
-double measured_temperature = 0;
-double measured_humidity = 0;
-
-// Voltage - Capacity pair table from thunderboard react
-// Algorithm assumes the values are arranged in a descending order.
-// The values in the table are base on the discharge curve from lygte-info.dk:
-// https://lygte-info.dk/review/batteries2012/Ikea%20Ladda%20AA%202450mAh%20%28White%29%20UK.html
-// Table modified for zigbee half percent steps.
-static voltage_capacity_pair_t vcPairs[] =
-{ { 1450, 100 }, { 1350, 92 }, { 1300, 78 }, { 1250, 24 }, { 1220, 13 },
-  { 1160, 5 }, { 1100, 2 }, { 900, 0 } };
+static int32_t measured_temperature = 0;
+static int32_t measured_humidity = 0;
+
+// Signal conditioning between sampling and attribute update
+static const struct sensor_filter_cfg temp_filter_cfg = {
+	.min = HDC2080_TEMPERATURE_MIN,
+	.max = HDC2080_TEMPERATURE_MAX,
+	.max_step = CONFIG_ZICADA_FILTER_TEMP_MAX_STEP,
+	.max_rejects = CONFIG_ZICADA_FILTER_MAX_REJECTS,
+	.ema_shift = CONFIG_ZICADA_FILTER_EMA_SHIFT,
+};
+
+static const struct sensor_filter_cfg humidity_filter_cfg = {
+	.min = HDC2080_HUMIDITY_MIN,
+	.max = HDC2080_HUMIDITY_MAX,
+	.max_step = CONFIG_ZICADA_FILTER_HUMIDITY_MAX_STEP,
+	.max_rejects = CONFIG_ZICADA_FILTER_MAX_REJECTS,
+	.ema_shift = CONFIG_ZICADA_FILTER_EMA_SHIFT,
+};
+
+static struct sensor_filter temp_filter;
+static struct sensor_filter humidity_filter;
 
 //---------------------------------------------------------------------------------------------
 // main
@@ -284,60 +345,199 @@ static voltage_capacity_pair_t vcPairs[] =
 
 int main (void)
 {
+	boot_phase_mark (BOOT_PHASE_MAIN);
 	LOG_INF ("Starting Zicada sensor");
 
+	// binary event log: validate the retained ring, log this boot and dump what was
+	// recorded before the reset
+	uint32_t reset_cause = 0;
+	hwinfo_get_reset_cause (&reset_cause);
+	hwinfo_clear_reset_cause ();
+	evt_log_init (reset_cause);
+	if (IS_ENABLED(CONFIG_ZICADA_EVT_LOG_DUMP_ON_BOOT)) evt_log_dump ();
+
+	// pin, software, watchdog and lockup resets keep the device powered: restart from the
+	// persisted state instead of taking a blocking sample and re-reporting everything
+	warm_restart = IS_ENABLED(CONFIG_ZICADA_WARM_RESTART) &&
+		(reset_cause & (RESET_PIN | RESET_SOFTWARE | RESET_WATCHDOG | RESET_CPU_LOCKUP | RESET_DEBUG));
+
+	// a watchdog that was running before a warm reset keeps running, feed it early
+	wdt_sup_init ();
+
+	// the live state is a snapshot in retained RAM: after a warm reset it is resumed as it
+	// was, including the contact state, so nothing is reported twice
+	persist_init (warm_restart);
+	struct persist_warm *warm = persist_get_warm ();
+	if (reset_cause & RESET_WATCHDOG) {
+		warm->wdt_resets++;
+		persist_seal ();
+	}
+	timebase_init ();
+	lfclk_mgr_init ();
+	res_stats_init (ZB_CONFIG_SCHEDULER_Q_SIZE, ZB_CONFIG_IOBUF_POOL_SIZE);
+	if (persist_warm_restored ()) {
+		current_hall_state = warm->hall_state;
+		sent_hall_state = warm->hall_state;
+		LOG_INF ("Resumed from retained snapshot (warm restart #%d)", warm->warm_restarts);
+		evt_log_put (EVT_WARM_RECOVERY, warm->hall_state, warm->warm_restarts);
+	}
+
 	// initialize
 	configure_gpio ();
-
-	// init HDC20xx
-	if (!device_is_ready(hdc20)) {
-		LOG_ERR("HDC20xx: device not ready");
-		return 0;
-	} else LOG_INF("HDC20xx: device ready");
-	
-	// get initial temperature and humidity
-	struct sensor_value temp, humidity;
-	sensor_sample_fetch(hdc20);
-	sensor_channel_get(hdc20, SENSOR_CHAN_AMBIENT_TEMP, &temp);
-	sensor_channel_get(hdc20, SENSOR_CHAN_HUMIDITY, &humidity);
-	measured_temperature = sensor_value_to_double(&temp);
-	measured_humidity = sensor_value_to_double(&humidity);
-	LOG_INF("Temp = %f C, RH = %f", measured_temperature, measured_humidity);
+	periph_pm_init ();
+	boot_phase_mark (BOOT_PHASE_GPIO);
 
 	// init Zigbee
 	register_factory_reset_button (BUTTON_0);
 	zigbee_erase_persistent_storage (ERASE_PERSISTENT_CONFIG);
+#if defined(CONFIG_ZIGBEE_ROLE_END_DEVICE)
 	zb_set_ed_timeout (ED_AGING_TIMEOUT_64MIN);
-    zb_set_keepalive_timeout (ZB_MILLISECONDS_TO_BEACON_INTERVAL(3600*1000));
+    zb_set_keepalive_timeout (ZB_MILLISECONDS_TO_BEACON_INTERVAL(KEEPALIVE_TIMEOUT_MSEC));
+#endif
 
 	// send things to endpoint 1 on the coordinator
 	dest_ctx.short_addr = DEST_SHORT_ADDR;
 	dest_ctx.endpoint = DEST_ENDPOINT;
 
-	// configure for lowest power
+#if defined(CONFIG_ZIGBEE_ROLE_END_DEVICE)
+	// configure for lowest power, a router keeps its receiver on to route for others
 	zigbee_configure_sleepy_behavior (true);
 	power_down_unused_ram ();
+#endif
 
 	// register switch device context (endpoints)
 	ZB_AF_REGISTER_DEVICE_CTX (&zicada_ctx);
 
 	// initialize application clusters
 	app_clusters_attr_init ();
+	dev_ctx.diag_attrs.reset_cause = reset_cause;
+	dev_ctx.diag_attrs.wdt_resets = warm->wdt_resets;
 
 	// register handlers to identify notifications
 	ZB_AF_SET_IDENTIFY_NOTIFICATION_HANDLER(SOURCE_ENDPOINT, identify_cb);
 
+	// responses to the device's own requests (coordinator time)
+	ZB_AF_SET_ENDPOINT_HANDLER(SOURCE_ENDPOINT, zcl_ep_handler);
+
 	// start Zigbee default thread
 	zigbee_enable ();
+	boot_phase_mark (BOOT_PHASE_STACK_ENABLED);
+	wdt_sup_start ();
 
 	LOG_INF ("Zicada sensor started");
 
+	// bring up the HDC2080 while the stack starts and commissions (the Zigbee thread has
+	// the higher priority), a sensor failure only disables temperature & humidity
+	init_temp_humidity_sensor ();
+	boot_phase_mark (BOOT_PHASE_SENSOR_READY);
+
 	// suspend main thread
 	while (1) {
 		k_sleep (K_FOREVER);
 	}
 }
 
+//---------------------------------------------------------------------------------------------
+// Temperature and humidity sensor bring-up, runs in the main thread
+//
+
+static void init_temp_humidity_sensor (void){
+
+	if (!device_is_ready(hdc20)) {
+		LOG_ERR("HDC20xx: device not ready, running without temperature & humidity");
+		evt_log_put(EVT_SENSOR_FAILED, -ENODEV, 0);
+		return;
+	}
+	LOG_INF("HDC20xx: device ready");
+	sensor_filter_init(&temp_filter, &temp_filter_cfg);
+	sensor_filter_init(&humidity_filter, &humidity_filter_cfg);
+	sensor_ok = true;
+
+	// a warm restart takes its first sample on schedule
+	if (warm_restart) return;
+
+	// get initial temperature and humidity
+	int err = sample_temp_humidity(&measured_temperature, &measured_humidity);
+	if (err) {
+		LOG_ERR("HDC20xx: initial sample failed: %d", err);
+		evt_log_put(EVT_SENSOR_FAILED, err, 0);
+		return;
+	}
+	LOG_INF("Temp = %d C/100, RH = %d %%/100", (int)measured_temperature, (int)measured_humidity);
+
+	// attributes belong to the Zigbee thread
+	ZB_SCHEDULE_APP_CALLBACK(apply_initial_sample, 0);
+}
+
+//---------------------------------------------------------------------------------------------
+// set the attributes from the sample taken at boot
+//
+
+static void apply_initial_sample (zb_bufid_t bufid){
+
+	ZVUNUSED(bufid);
+
+	// the first scheduled check may have been faster
+	if (dev_ctx.temp_attrs.measure_value != ZB_ZCL_TEMP_MEASUREMENT_VALUE_UNKNOWN) return;
+
+	// the boot sample seeds the filters, an implausible one leaves the attributes unknown
+	int32_t temperature, humidity;
+	if (!sensor_filter_update(&temp_filter, measured_temperature, &temperature) ||
+	    !sensor_filter_update(&humidity_filter, measured_humidity, &humidity)) {
+		evt_log_put(EVT_SAMPLE_REJECTED, 0, measured_temperature);
+		return;
+	}
+
+	zb_int16_t temperature_attribute = (zb_int16_t)temperature;
+	zb_int16_t humidity_attribute = (zb_int16_t)humidity;
+
+	zb_zcl_set_attr_val(SOURCE_ENDPOINT, ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, ZB_ZCL_CLUSTER_SERVER_ROLE,
+		ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, (zb_uint8_t *)&temperature_attribute, ZB_FALSE);
+	zb_zcl_set_attr_val(SOURCE_ENDPOINT, ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT, ZB_ZCL_CLUSTER_SERVER_ROLE,
+		ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID, (zb_uint8_t *)&humidity_attribute, ZB_FALSE);
+}
+
+//---------------------------------------------------------------------------------------------
+// Take a burst of temperature and humidity samples, returns the medians in attribute units
+//
+
+static int32_t sensor_value_to_attr (const struct sensor_value *val, int32_t multiplier){
+
+	// val2 is in millionths and has the sign of val1
+	return val->val1 * multiplier + (val->val2 * multiplier) / 1000000;
+}
+
+static int sample_temp_humidity (int32_t *temperature, int32_t *humidity){
+
+	int32_t temp_samples[CONFIG_ZICADA_FILTER_BURST];
+	int32_t humidity_samples[CONFIG_ZICADA_FILTER_BURST];
+	uint8_t n = 0;
+	int err = 0;
+
+	// the bus is only powered for the burst, channel_get() reads the driver's copy
+	err = periph_pm_get(PERIPH_PM_I2C);
+	if (err) return err;
+	for (int i = 0; i < CONFIG_ZICADA_FILTER_BURST; i++) {
+		err = sensor_sample_fetch(hdc20);
+		if (err) continue;
+
+		struct sensor_value temp, hum;
+		sensor_channel_get(hdc20, SENSOR_CHAN_AMBIENT_TEMP, &temp);
+		sensor_channel_get(hdc20, SENSOR_CHAN_HUMIDITY, &hum);
+		temp_samples[n] = sensor_value_to_attr(&temp, ZCL_TEMPERATURE_MEASUREMENT_MEASURED_VALUE_MULTIPLIER);
+		humidity_samples[n] = sensor_value_to_attr(&hum, ZCL_HUMIDITY_MEASUREMENT_MEASURED_VALUE_MULTIPLIER);
+		n++;
+	}
+	periph_pm_put(PERIPH_PM_I2C);
+
+	// a failed fetch within the burst only shortens it
+	if (n == 0) return err;
+
+	*temperature = sensor_filter_median(temp_samples, n);
+	*humidity = sensor_filter_median(humidity_samples, n);
+	return 0;
+}
+
 //---------------------------------------------------------------------------------------------
 // Temperature and humidity check routine
 //
@@ -346,22 +546,45 @@ static void check_temp_humidity(zb_bufid_t bufid){
 
 	ZVUNUSED(bufid);
 
-	sensor_sample_fetch(hdc20);
+	wdt_sup_checkin(WDT_SUP_SENSOR);
 
-	int16_t temperature_attribute = 0;
+	struct app_state app_state;
+	app_state_get(&app_state);
+	uint32_t jobs = app_sched_jobs(APP_WAKE_SENSOR, &app_state);
 
-	struct sensor_value temp;
-	sensor_channel_get(hdc20, SENSOR_CHAN_AMBIENT_TEMP, &temp);
-	measured_temperature = sensor_value_to_double(&temp);
-	
-	// Convert measured value to attribute value, as specified in ZCL
-	temperature_attribute =
-		(int16_t)(measured_temperature *
-			  ZCL_TEMPERATURE_MEASUREMENT_MEASURED_VALUE_MULTIPLIER);
+	// a due time sync goes out with this wake-up instead of waking up for it
+	if (jobs & APP_JOB_TIME_SYNC) timebase_poll();
+
+	// degraded mode: stop sampling, contact and battery reports keep working
+	if (!(jobs & APP_JOB_SAMPLE)) {
+		LOG_WRN("No temperature & humidity sensor, stopping checks");
+		wdt_sup_disarm(WDT_SUP_SENSOR);
+		return;
+	}
+
+	int err = sample_temp_humidity(&measured_temperature, &measured_humidity);
+	if (err) {
+		LOG_ERR("Failed to fetch temperature & humidity sample: %d", err);
+		evt_log_put(EVT_SENSOR_FAILED, err, 0);
+		schedule_temp_humidity_check();
+		return;
+	}
+
+	int32_t filtered;
+	zb_zcl_status_t status;
+
+	// an outlier keeps the previous attribute value, so no report is triggered
+	int16_t temperature_attribute = dev_ctx.temp_attrs.measure_value;
+	if (sensor_filter_update(&temp_filter, measured_temperature, &filtered)) {
+		temperature_attribute = (int16_t)filtered;
+	} else {
+		LOG_DBG("Temperature sample rejected: %d C/100", (int)measured_temperature);
+		evt_log_put(EVT_SAMPLE_REJECTED, ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, measured_temperature);
+	}
 	//LOG_INF("Attribute T:%10d", temperature_attribute);
 
 	// Set ZCL attribute
-	zb_zcl_status_t status = zb_zcl_set_attr_val(
+	status = zb_zcl_set_attr_val(
 		SOURCE_ENDPOINT,							// 1
 		ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,			// 0x0402
 		ZB_ZCL_CLUSTER_SERVER_ROLE,					// 1
@@ -371,21 +594,20 @@ static void check_temp_humidity(zb_bufid_t bufid){
 	);
 	if (status) {
 		LOG_ERR("Failed to set ZCL attribute: %d", status);
+		evt_log_put(EVT_ATTR_SET_FAILED, status, ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT);
 	} else{
-		LOG_INF("Temperature attribute update: %.2f C", measured_temperature);
+		evt_log_put(EVT_TEMP_UPDATE, 0, temperature_attribute);
+		LOG_DBG("Temperature attribute update: %d C/100", temperature_attribute);
 		//if(measured_temperature++ >= 50) measured_temperature = 0; // increment temperature for testing
 	}
 
-	int16_t humidity_attribute = 0;
-	
-	struct sensor_value humidity;
-	sensor_channel_get(hdc20, SENSOR_CHAN_HUMIDITY, &humidity);
-	measured_humidity = sensor_value_to_double(&humidity);
-	
-	// Convert measured value to attribute value, as specified in ZCL
-	humidity_attribute =
-		(int16_t)(measured_humidity *
-			  ZCL_HUMIDITY_MEASUREMENT_MEASURED_VALUE_MULTIPLIER);
+	int16_t humidity_attribute = dev_ctx.humidity_attrs.measure_value;
+	if (sensor_filter_update(&humidity_filter, measured_humidity, &filtered)) {
+		humidity_attribute = (int16_t)filtered;
+	} else {
+		LOG_DBG("Humidity sample rejected: %d %%/100", (int)measured_humidity);
+		evt_log_put(EVT_SAMPLE_REJECTED, ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT, measured_humidity);
+	}
 	//LOG_INF("Attribute H:%10d", humidity_attribute);
 
 	// Set ZCL attribute
@@ -399,19 +621,143 @@ static void check_temp_humidity(zb_bufid_t bufid){
 	);
 	if (status) {
 		LOG_ERR("Failed to set ZCL attribute: %d", status);
+		evt_log_put(EVT_ATTR_SET_FAILED, status, ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT);
 	} else{
-		LOG_INF("Humidity attribute update: %.2f%%", measured_humidity);
+		evt_log_put(EVT_HUMIDITY_UPDATE, 0, humidity_attribute);
+		LOG_DBG("Humidity attribute update: %d %%/100", humidity_attribute);
+		if (ZB_JOINED()) boot_phase_mark(BOOT_PHASE_FIRST_REPORT);
 	}
 
-	if(ZB_JOINED()){
+	// remember the values and the battery check phase, NVRAM writes of this and the other
+	// changes are batched into this wake-up
+	struct persist_data *state = persist_get();
+	state->temperature = temperature_attribute;
+	state->humidity = humidity_attribute;
+	if (state->battery_phase < UINT8_MAX) state->battery_phase++;
+	persist_mark(PERSIST_DIRTY_VALUES);
+	if (jobs & APP_JOB_PERSIST) persist_flush();
+
+	// the reports of this cycle are queued now
+	res_stats_sample();
+
+	schedule_temp_humidity_check();
+}
+
+//---------------------------------------------------------------------------------------------
+// schedule the next temperature and humidity check while joined
+//
+
+static void schedule_temp_humidity_check (void){
+
+	struct app_state app_state;
+	app_state_get(&app_state);
+	uint32_t delay = app_sched_next(APP_WAKE_SENSOR, &app_state);
+
+	if(delay){
 		zb_ret_t zb_err = ZB_SCHEDULE_APP_ALARM(
 			check_temp_humidity, 0,
-			ZB_MILLISECONDS_TO_BEACON_INTERVAL(TEMP_HUMIDITY_CHECK_PERIOD_MSEC));
-		if (zb_err) LOG_ERR("Failed to schedule temperature & humidity check alarm: %d", zb_err);
-		else LOG_INF("Scheduled next temperature & humidity check alarm in %ds", TEMP_HUMIDITY_CHECK_PERIOD_MSEC/1000);
+			ZB_MILLISECONDS_TO_BEACON_INTERVAL(delay));
+		if (zb_err) {
+			LOG_ERR("Failed to schedule temperature & humidity check alarm: %d", zb_err);
+			evt_log_put(EVT_ALARM_FAILED, zb_err, (int32_t)(uintptr_t)check_temp_humidity);
+			res_stats_fail(RES_STATS_ALARM);
+		}
+		else LOG_DBG("Scheduled next temperature & humidity check alarm in %ds", delay/1000);
+	} else {
+		// checks stop until the next join
+		wdt_sup_disarm(WDT_SUP_SENSOR);
 	}
 }
 
+//---------------------------------------------------------------------------------------------
+// device state the schedule (app_sched.c) decides on
+//
+
+static void app_state_get (struct app_state *state){
+
+	state->joined = ZB_JOINED();
+	state->sensor_ok = sensor_ok;
+	state->restored = false;
+	state->battery_phase = persist_get()->battery_phase;
+}
+
+//---------------------------------------------------------------------------------------------
+// refresh the diagnostics cluster attributes
+//
+
+static void update_diag_attributes (void){
+
+	const struct mem_stats *mem = mem_stats_get();
+	struct zb_zcl_zicada_diag_attrs *diag = &dev_ctx.diag_attrs;
+
+	mem_stats_update();
+	mem_stats_print();
+
+	// not reportable, so the storage is written directly
+	diag->stack_zboss = MIN(mem->stack_used[MEM_STATS_ZBOSS], UINT16_MAX);
+	diag->stack_main = MIN(mem->stack_used[MEM_STATS_MAIN], UINT16_MAX);
+	diag->stack_log = MIN(mem->stack_used[MEM_STATS_LOG], UINT16_MAX);
+	diag->stack_workq = MIN(mem->stack_used[MEM_STATS_WORKQ], UINT16_MAX);
+	diag->heap_max = MIN(mem->heap_max_used, UINT16_MAX);
+	diag->wdt_resets = persist_get_warm()->wdt_resets;
+
+	const struct lfclk_stats *lfclk = lfclk_mgr_get();
+	diag->lfclk_status = lfclk->status;
+	diag->lfclk_accuracy = lfclk->accuracy_ppm;
+	diag->lfclk_drift = lfclk->drift_ppm;
+	diag->time_error = lfclk->time_error_ms;
+	diag->rc_cal_saved = lfclk->cal_saved;
+
+	const struct res_stats *res = res_stats_get();
+	res_stats_update();
+	res_stats_print();
+	diag->sched_fails = MIN(res->failures[RES_STATS_SCHED] + res->failures[RES_STATS_ALARM], UINT16_MAX);
+	diag->alarm_free = MIN(res->min_free[RES_STATS_ALARM], UINT16_MAX);
+	diag->buf_in_free = MIN(res->min_free[RES_STATS_BUF_IN], UINT16_MAX);
+	diag->buf_out_free = MIN(res->min_free[RES_STATS_BUF_OUT], UINT16_MAX);
+	diag->buf_fails = MIN(res->failures[RES_STATS_BUF_IN] + res->failures[RES_STATS_BUF_OUT], UINT16_MAX);
+	diag->nvram_free = MIN(res->min_free[RES_STATS_NVRAM], UINT16_MAX);
+	diag->nvram_fails = res->failures[RES_STATS_NVRAM];
+	diag->nvram_erases = res->nvram_erases;
+	diag->nvram_lifetime = res->nvram_lifetime;
+	diag->persist_writes = persist_get_stats()->writes;
+	diag->persist_skipped = persist_get_stats()->skipped;
+
+	struct periph_pm_stats i2c, saadc;
+	periph_pm_stats_get(PERIPH_PM_I2C, &i2c);
+	periph_pm_stats_get(PERIPH_PM_SAADC, &saadc);
+	diag->i2c_active = i2c.active_ms;
+	diag->saadc_active = saadc.active_ms;
+	diag->pm_errors = MIN(i2c.errors + saadc.errors, UINT16_MAX);
+	LOG_INF("Peripherals: i2c %u activations / %u ms, saadc %u activations / %u ms, %u errors",
+		i2c.activations, i2c.active_ms, saadc.activations, saadc.active_ms, i2c.errors + saadc.errors);
+
+	const struct delivery_stats *delivery = delivery_get();
+	diag->contact_retries = delivery->retries[DELIVERY_CONTACT];
+	diag->contact_drops = delivery->dropped[DELIVERY_CONTACT];
+	LOG_INF("Contact commands: %u sent, %u confirmed, %u retries, %u dropped, %u superseded",
+		delivery->sent[DELIVERY_CONTACT], delivery->confirmed[DELIVERY_CONTACT],
+		delivery->retries[DELIVERY_CONTACT], delivery->dropped[DELIVERY_CONTACT],
+		delivery->superseded[DELIVERY_CONTACT]);
+}
+
+//---------------------------------------------------------------------------------------------
+// fit the poll and keepalive interval into the parent's aging timeout, the margin follows the
+// LF clock accuracy
+//
+
+static void update_poll_interval (void){
+
+	uint32_t interval = lfclk_mgr_update();
+
+#if defined(CONFIG_ZIGBEE_ROLE_END_DEVICE)
+	zb_zdo_pim_set_long_poll_interval (interval);
+	zb_set_keepalive_timeout (ZB_MILLISECONDS_TO_BEACON_INTERVAL(interval));
+#else
+	ZVUNUSED(interval);
+#endif
+}
+
 //---------------------------------------------------------------------------------------------
 // use the adc to periodically read the battery voltage on vdd pin and update the 
 // battery voltage attribute. if joined to a network, send the attribute report.
@@ -419,17 +765,16 @@ static void check_temp_humidity(zb_bufid_t bufid){
 // samples. the zephyr saadc driver does not have this capability.
 //
 
-#define NRFX_SAADC_CONFIG_IRQ_PRIORITY 6
-
-// Battery level update routine
-static void check_battery_level(zb_bufid_t bufid){
+// one battery voltage measurement in mV, the SAADC is only powered for the conversion
+static int measure_battery_mv (int32_t *adc_mv){
 
 	nrfx_err_t status;
 	nrfx_saadc_channel_t channel;
 	uint16_t sample;
 
 	// initialize adc
-	status = nrfx_saadc_init (NRFX_SAADC_CONFIG_IRQ_PRIORITY);
+	int err = periph_pm_get (PERIPH_PM_SAADC);
+	if (err) return err;
 
 	channel.channel_config.resistor_p = NRF_SAADC_RESISTOR_DISABLED;
 	channel.channel_config.resistor_n = NRF_SAADC_RESISTOR_DISABLED;
@@ -455,13 +800,18 @@ static void check_battery_level(zb_bufid_t bufid){
     status = nrfx_saadc_mode_trigger ();
 
 	// shutdown adc to save power
-	nrfx_saadc_uninit ();
+	periph_pm_put (PERIPH_PM_SAADC);
 
 	// convert to millivolts
 	int32_t resolution = 14;
 	int32_t gainrecip = 6;
 	int32_t ref_mv = 600;
-	int32_t adc_mv = (sample * ref_mv * gainrecip) >> resolution;
+	*adc_mv = (sample * ref_mv * gainrecip) >> resolution;
+	return 0;
+}
+
+// set the battery attribute from a measurement
+static void update_battery_level (int32_t adc_mv){
 
 	// convert to percentage remaining
 	zb_uint8_t battery_level = NiMH_CalculateLevel(adc_mv);
@@ -477,17 +827,59 @@ static void check_battery_level(zb_bufid_t bufid){
                          ZB_FALSE);
 	if (stat) {
 		LOG_ERR("Failed to set battery attribute: %d", stat);
+		evt_log_put(EVT_ATTR_SET_FAILED, stat, ZB_ZCL_CLUSTER_ID_POWER_CONFIG);
 	} else{
-		LOG_INF("battery attribute update: %d mV / %d%%", adc_mv, battery_level);
+		evt_log_put(EVT_BATTERY_UPDATE, battery_level, adc_mv);
+		LOG_DBG("battery attribute update: %d mV / %d%%", adc_mv, battery_level);
 	}
 
+	if (battery_level < LOW_BATTERY_LEVEL_PERCENT) led_pattern_play(LED_PATTERN_LOW_BATTERY);
+	persist_get()->battery_percent = percentage_attribute;
+}
+
+// Battery level update routine
+static void check_battery_level(zb_bufid_t bufid){
+
+	struct app_state app_state;
+	app_state_get(&app_state);
+	uint32_t jobs = app_sched_jobs(APP_WAKE_BATTERY, &app_state);
+
+	// a due time sync goes out with this wake-up as well, it is the one left in degraded mode
+	if (jobs & APP_JOB_TIME_SYNC) timebase_poll();
+
+	if (jobs & APP_JOB_BATTERY) {
+		int32_t adc_mv;
+
+		// without a measurement the attribute keeps its last value until the next check
+		int err = measure_battery_mv(&adc_mv);
+		if (err) LOG_ERR("Battery measurement skipped: %d", err);
+		else update_battery_level(adc_mv);
+
+		// health data rides along with the (rare) battery check, so does the poll interval
+		// that follows the measured clock drift
+		update_poll_interval();
+		update_diag_attributes();
+
+		// restart the battery check phase
+		persist_get()->battery_phase = 0;
+		persist_mark(PERSIST_DIRTY_VALUES);
+	}
+
+	// also the flush of degraded mode and of sensor checks that failed to sample
+	if (jobs & APP_JOB_PERSIST) persist_flush();
+
 	//Schedule next alarm
-	if(ZB_JOINED()){
+	uint32_t delay = app_sched_next(APP_WAKE_BATTERY, &app_state);
+	if(delay){
 		zb_ret_t zb_err = ZB_SCHEDULE_APP_ALARM(
 			check_battery_level, 0,
-			ZB_MILLISECONDS_TO_BEACON_INTERVAL(BATTERY_CHECK_PERIOD_MSEC));
-		if (zb_err) LOG_ERR("Failed to schedule battery check alarm: %d", zb_err);
-		else LOG_INF("Scheduled next battery check alarm in %ds", BATTERY_CHECK_PERIOD_MSEC/1000);
+			ZB_MILLISECONDS_TO_BEACON_INTERVAL(delay));
+		if (zb_err) {
+			LOG_ERR("Failed to schedule battery check alarm: %d", zb_err);
+			evt_log_put(EVT_ALARM_FAILED, zb_err, (int32_t)(uintptr_t)check_battery_level);
+			res_stats_fail(RES_STATS_ALARM);
+		}
+		else LOG_DBG("Scheduled next battery check alarm in %ds", delay/1000);
 	}
 }
 
@@ -498,6 +890,14 @@ static void check_battery_level(zb_bufid_t bufid){
 void zboss_signal_handler(zb_bufid_t bufid){
 
 	static bool lastJoin = false;
+	static bool state_applied = false;
+
+	// boot phase timestamps
+	zb_zdo_app_signal_type_t sig = zb_get_app_signal(bufid, NULL);
+	if (sig == ZB_COMMON_SIGNAL_CAN_SLEEP) boot_phase_mark(BOOT_PHASE_FIRST_SLEEP);
+	else if (sig == ZB_ZDO_SIGNAL_SKIP_STARTUP) boot_phase_mark(BOOT_PHASE_STACK_STARTED);
+
+	wdt_sup_checkin(WDT_SUP_ZIGBEE);
 
 	// Let default signal handler process the signal
 	ZB_ERROR_CHECK(zigbee_default_signal_handler(bufid));
@@ -508,32 +908,58 @@ void zboss_signal_handler(zb_bufid_t bufid){
 		zb_buf_free(bufid);
 	}
 
-	// once joined, set the poll and battery voltage intervals to an hour.
+	// once joined, set the poll interval (about an hour, see update_poll_interval()) and
+	// start the battery voltage checks.
 	// if using a sparkfun board with a spi flash chip, drop the flash chip 
 	// into power down mode again just in case missed it the first time.
 	bool thisJoin = ZB_JOINED();
 	if ((lastJoin == false) && (thisJoin == true)) {
 		LOG_INF ("joined network!");
-		dk_set_led_off (ZIGBEE_NETWORK_STATE_LED);
-		zb_zdo_pim_set_long_poll_interval (3600*1000);
+		evt_log_put(EVT_JOINED, 0, 0);
+		boot_phase_mark (BOOT_PHASE_JOINED);
+		led_pattern_set_base (false);
+		update_poll_interval ();
+
+		// the persisted state was loaded from NVRAM during stack startup, apply it once
+		struct app_state app_state;
+		bool restored = !state_applied && IS_ENABLED(CONFIG_ZICADA_WARM_RESTART) && persist_restored();
+		if (restored) restore_persisted_state ();
+		state_applied = true;
+
+		// a restored battery check phase is resumed instead of checking again right away
+		app_state_get(&app_state);
+		app_state.restored = restored;
+		uint32_t sensor_delay = app_sched_first(APP_WAKE_SENSOR, &app_state);
+		uint32_t battery_delay = app_sched_first(APP_WAKE_BATTERY, &app_state);
+
 		configure_attribute_reporting ();
 		
 		// Start temperature and humidity checking
 		zb_ret_t err = RET_OK;
-		err = ZB_SCHEDULE_APP_ALARM(check_temp_humidity, 0, ZB_MILLISECONDS_TO_BEACON_INTERVAL(TEMP_HUMIDITY_CHECK_INITIAL_DELAY_MSEC));
+		err = ZB_SCHEDULE_APP_ALARM(check_temp_humidity, 0, ZB_MILLISECONDS_TO_BEACON_INTERVAL(sensor_delay));
 		if (err) LOG_ERR("Failed to schedule temperature & humidity check alarm: %d", err);
-		else LOG_INF("Scheduled first temperature & humidity check alarm in %d s", TEMP_HUMIDITY_CHECK_INITIAL_DELAY_MSEC/1000);
+		else {
+			LOG_INF("Scheduled first temperature & humidity check alarm in %d s", sensor_delay/1000);
+			wdt_sup_arm(WDT_SUP_SENSOR);
+		}
 
 		// Start battery level checking
 		err = RET_OK;
-		err = ZB_SCHEDULE_APP_ALARM(check_battery_level, 0,	ZB_MILLISECONDS_TO_BEACON_INTERVAL(BATTERY_CHECK_INITIAL_DELAY_MSEC));
+		err = ZB_SCHEDULE_APP_ALARM(check_battery_level, 0,	ZB_MILLISECONDS_TO_BEACON_INTERVAL(battery_delay));
 		if (err) LOG_ERR("Failed to schedule battery check alarm: %d", err);
-		else LOG_INF("Scheduled first battery check alarm in %d s", BATTERY_CHECK_INITIAL_DELAY_MSEC/1000);
+		else LOG_INF("Scheduled first battery check alarm in %d s", battery_delay/1000);
+
+#ifdef CONFIG_ZICADA_BINDING
+		// the coordinator keeps getting the contact command once a light is bound
+		err = zb_buf_get_out_delayed(bind_coordinator);
+		if (err) LOG_ERR("No buffer to bind the coordinator: %d", err);
+#endif
 
 	} else if ((lastJoin == true) && (thisJoin == false)) {
 		LOG_INF ("left network!");
+		evt_log_put(EVT_LEFT, 0, 0);
 		// no longer joined, turn on network state led and stop reading battery voltage
-		dk_set_led_on (ZIGBEE_NETWORK_STATE_LED);
+		led_pattern_set_base (true);
 
 		zb_ret_t err = RET_OK;
 		err = ZB_SCHEDULE_APP_ALARM(attempt_rejoin, 0, ZB_MILLISECONDS_TO_BEACON_INTERVAL(REJOIN_ATTEMPT_INITIAL_DELAY_MSEC));
@@ -548,8 +974,8 @@ void zboss_signal_handler(zb_bufid_t bufid){
 // configure attribute reporting
 //
 
-#define RPT_MIN 0x0001
-#define RPT_MAX 0xFFFE
+// temperature, humidity, battery percentage and contact are configured below, each needs a slot
+BUILD_ASSERT(ZB_ZICADA_REPORT_ATTR_COUNT >= 4, "reporting context too small for the configured reports");
 
 static void configure_attribute_reporting (void){
 
@@ -557,6 +983,9 @@ static void configure_attribute_reporting (void){
 	// reports for the attribute. If it is set to 0x0000 and minimum reporting interval is set 
 	// to something other than 0xffff then the device shall not do periodic reporting.
 	// It can still send reports on value change in the last case, but not periodic.
+	//
+	// Existing reporting info (restored by the stack or configured by the coordinator) is
+	// not overridden, the values below are only the defaults for a fresh join.
 
 	zb_zcl_reporting_info_t reporting_info;
 	zb_ret_t status;
@@ -567,8 +996,8 @@ static void configure_attribute_reporting (void){
 	reporting_info.cluster_id = ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT;
 	reporting_info.cluster_role = ZB_ZCL_CLUSTER_SERVER_ROLE;
 	reporting_info.attr_id = ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID;
-	reporting_info.dst.short_addr = 0x0000;
-	reporting_info.dst.endpoint = 1;
+	reporting_info.dst.short_addr = dest_ctx.short_addr;
+	reporting_info.dst.endpoint = dest_ctx.endpoint;
 	reporting_info.dst.profile_id = ZB_AF_HA_PROFILE_ID;
 	reporting_info.u.send_info.min_interval = RPT_MIN;
 	reporting_info.u.send_info.max_interval = RPT_MAX;
@@ -576,7 +1005,7 @@ static void configure_attribute_reporting (void){
 	reporting_info.u.send_info.reported_value.u16 = 0;
 	reporting_info.u.send_info.def_min_interval = RPT_MIN;
 	reporting_info.u.send_info.def_max_interval = RPT_MAX;
-	status = zb_zcl_put_reporting_info(&reporting_info, ZB_TRUE); 
+	status = zb_zcl_put_reporting_info(&reporting_info, ZB_FALSE);
 	if (status == RET_OK) {
         LOG_INF("Temperature reporting configured successfully");
     } else {
@@ -589,8 +1018,8 @@ static void configure_attribute_reporting (void){
 	reporting_info.cluster_id = ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT;
 	reporting_info.cluster_role = ZB_ZCL_CLUSTER_SERVER_ROLE;
 	reporting_info.attr_id = ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID;
-	reporting_info.dst.short_addr = 0x0000;
-	reporting_info.dst.endpoint = 1;
+	reporting_info.dst.short_addr = dest_ctx.short_addr;
+	reporting_info.dst.endpoint = dest_ctx.endpoint;
 	reporting_info.dst.profile_id = ZB_AF_HA_PROFILE_ID;
 	reporting_info.u.send_info.min_interval = RPT_MIN;
 	reporting_info.u.send_info.max_interval = RPT_MAX;
@@ -598,7 +1027,7 @@ static void configure_attribute_reporting (void){
 	reporting_info.u.send_info.reported_value.u16 = 0;
 	reporting_info.u.send_info.def_min_interval = RPT_MIN;
 	reporting_info.u.send_info.def_max_interval = RPT_MAX;
-	status = zb_zcl_put_reporting_info(&reporting_info, ZB_TRUE);  
+	status = zb_zcl_put_reporting_info(&reporting_info, ZB_FALSE);
 	if (status == RET_OK) {
         LOG_INF("Humidity reporting configured successfully");
     } else {
@@ -611,8 +1040,8 @@ static void configure_attribute_reporting (void){
 	reporting_info.cluster_id = ZB_ZCL_CLUSTER_ID_POWER_CONFIG;
 	reporting_info.cluster_role = ZB_ZCL_CLUSTER_SERVER_ROLE;
 	reporting_info.attr_id = ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_PERCENTAGE_REMAINING_ID;
-	reporting_info.dst.short_addr = 0x0000;
-	reporting_info.dst.endpoint = 1;
+	reporting_info.dst.short_addr = dest_ctx.short_addr;
+	reporting_info.dst.endpoint = dest_ctx.endpoint;
 	reporting_info.dst.profile_id = ZB_AF_HA_PROFILE_ID;
 	reporting_info.u.send_info.min_interval = RPT_MIN;
 	reporting_info.u.send_info.max_interval = RPT_MAX;
@@ -620,12 +1049,92 @@ static void configure_attribute_reporting (void){
 	reporting_info.u.send_info.reported_value.u8 = 0;
 	reporting_info.u.send_info.def_min_interval = RPT_MIN;
 	reporting_info.u.send_info.def_max_interval = RPT_MAX;
-	status = zb_zcl_put_reporting_info(&reporting_info, ZB_TRUE); 
+	status = zb_zcl_put_reporting_info(&reporting_info, ZB_FALSE);
 	if (status == RET_OK) {
         LOG_INF("Power reporting configured successfully");
     } else {
         LOG_ERR("Failed to configure power reporting: %d", status);
-    }	
+    }
+
+	memset(&reporting_info, 0, sizeof(reporting_info));
+	reporting_info.direction = ZB_ZCL_CONFIGURE_REPORTING_SEND_REPORT;
+	reporting_info.ep = SOURCE_ENDPOINT;
+	reporting_info.cluster_id = ZB_ZCL_CLUSTER_ID_BINARY_INPUT;
+	reporting_info.cluster_role = ZB_ZCL_CLUSTER_SERVER_ROLE;
+	reporting_info.attr_id = ZB_ZCL_ATTR_BINARY_INPUT_PRESENT_VALUE_ID;
+	reporting_info.dst.short_addr = dest_ctx.short_addr;
+	reporting_info.dst.endpoint = dest_ctx.endpoint;
+	reporting_info.dst.profile_id = ZB_AF_HA_PROFILE_ID;
+	reporting_info.u.send_info.min_interval = RPT_MIN;
+	reporting_info.u.send_info.max_interval = CONTACT_RPT_MAX;
+	reporting_info.u.send_info.delta.u8 = 0x00;
+	reporting_info.u.send_info.reported_value.u8 = 0;
+	reporting_info.u.send_info.def_min_interval = RPT_MIN;
+	reporting_info.u.send_info.def_max_interval = CONTACT_RPT_MAX;
+	status = zb_zcl_put_reporting_info(&reporting_info, ZB_FALSE);
+	if (status == RET_OK) {
+        LOG_INF("Contact reporting configured successfully");
+    } else {
+        LOG_ERR("Failed to configure contact reporting: %d", status);
+    }
+
+	struct persist_data *state = persist_get();
+
+	// after a restart the coordinator already has the persisted values, don't report them again
+	if (IS_ENABLED(CONFIG_ZICADA_WARM_RESTART) && persist_restored()) {
+		restore_reported_value(ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+			ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, (zb_uint16_t)state->temperature);
+		restore_reported_value(ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,
+			ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID, (zb_uint16_t)state->humidity);
+		restore_reported_value(ZB_ZCL_CLUSTER_ID_POWER_CONFIG,
+			ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_PERCENTAGE_REMAINING_ID, state->battery_percent);
+	}
+
+	// the contact state is only known to the coordinator after a warm restart
+	if (persist_warm_restored()) {
+		restore_reported_value(ZB_ZCL_CLUSTER_ID_BINARY_INPUT,
+			ZB_ZCL_ATTR_BINARY_INPUT_PRESENT_VALUE_ID, persist_get_warm()->hall_state);
+	}
+
+	if (IS_ENABLED(CONFIG_ZICADA_WARM_RESTART) && !(state->flags & PERSIST_FLAG_REPORTING_CONFIGURED)) {
+		state->flags |= PERSIST_FLAG_REPORTING_CONFIGURED;
+		persist_mark(PERSIST_DIRTY_CONFIG);
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// mark a persisted value as already reported
+//
+
+static void restore_reported_value (zb_uint16_t cluster_id, zb_uint16_t attr_id, zb_uint16_t value){
+
+	zb_zcl_reporting_info_t *info = zb_zcl_find_reporting_info(
+		SOURCE_ENDPOINT, cluster_id, ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id);
+
+	if (info == NULL) return;
+
+	// 8 bit attributes use the low byte of the union
+	info->u.send_info.reported_value.u16 = value;
+	ZB_ZCL_CLR_REPORTING_FLAG(info, ZB_ZCL_REPORT_ATTR);
+}
+
+//---------------------------------------------------------------------------------------------
+// restore attribute values persisted before the reset
+//
+
+static void restore_persisted_state (void){
+
+	struct persist_data *state = persist_get();
+
+	// a sample taken at boot is newer than the persisted values
+	if (dev_ctx.temp_attrs.measure_value == ZB_ZCL_TEMP_MEASUREMENT_VALUE_UNKNOWN) {
+		dev_ctx.temp_attrs.measure_value = state->temperature;
+		dev_ctx.humidity_attrs.measure_value = state->humidity;
+	}
+	dev_ctx.power_attr.percent_remaining = state->battery_percent;
+
+	LOG_INF("Restored persisted state, battery phase %d", state->battery_phase);
+	evt_log_put(EVT_STATE_RESTORED, state->battery_phase, 0);
 }
 
 //---------------------------------------------------------------------------------------------
@@ -647,13 +1156,19 @@ static void configure_gpio (void){
     err = gpio_pin_configure_dt(&hall_sensor, GPIO_INPUT);
     if (err != 0) LOG_ERR("Failed to configure hall sensor GPIO: %d", err);
 
+	// after a warm restart wait for the opposite of the resumed state, like the interrupt does
 	static struct gpio_callback hall_sensor_cb_data;
-	gpio_pin_interrupt_configure_dt(&hall_sensor, GPIO_INT_LEVEL_LOW); // much lower power than EDGE_BOTH
+	gpio_pin_interrupt_configure_dt(&hall_sensor,
+		current_hall_state ? GPIO_INT_LEVEL_HIGH : GPIO_INT_LEVEL_LOW); // much lower power than EDGE_BOTH
 	gpio_init_callback(&hall_sensor_cb_data, hall_sensor_interrupt_callback, BIT(hall_sensor.pin));
 	gpio_add_callback(hall_sensor.port, &hall_sensor_cb_data);
 	
+	// blink patterns run on the PWM peripheral without waking the CPU
+	err = led_pattern_init ();
+	if (err) LOG_ERR ("Cannot init LED patterns (err: %d)", err);
+
 	// turn led on until network is joined
-	dk_set_led_on (ZIGBEE_NETWORK_STATE_LED); 
+	led_pattern_set_base (true);
 }
 
 
@@ -703,19 +1218,24 @@ static void app_clusters_attr_init (void){
 	dev_ctx.power_attr.quantity              = 1;
 	dev_ctx.power_attr.percent_remaining     = ZB_ZCL_POWER_CONFIG_BATTERY_REMAINING_UNKNOWN;
 
-	/* Temperature */
-	dev_ctx.temp_attrs.measure_value = measured_temperature * ZCL_TEMPERATURE_MEASUREMENT_MEASURED_VALUE_MULTIPLIER;
+	/* Temperature, unknown until the first sample */
+	dev_ctx.temp_attrs.measure_value = ZB_ZCL_TEMP_MEASUREMENT_VALUE_UNKNOWN;
 	dev_ctx.temp_attrs.min_measure_value = ZB_ZCL_TEMP_MEASUREMENT_MIN_VALUE_DEFAULT_VALUE;
 	dev_ctx.temp_attrs.max_measure_value = ZB_ZCL_TEMP_MEASUREMENT_MAX_VALUE_DEFAULT_VALUE;
 	dev_ctx.temp_attrs.tolerance = ZB_ZCL_ATTR_TEMP_MEASUREMENT_TOLERANCE_MAX_VALUE;
 
 	/* Humidity */
-	dev_ctx.humidity_attrs.measure_value = measured_humidity * ZCL_HUMIDITY_MEASUREMENT_MEASURED_VALUE_MULTIPLIER;
+	dev_ctx.humidity_attrs.measure_value = ZB_ZCL_REL_HUMIDITY_MEASUREMENT_VALUE_UNKNOWN;
 	dev_ctx.humidity_attrs.min_measure_value = ZB_ZCL_REL_HUMIDITY_MEASUREMENT_MIN_VALUE_DEFAULT_VALUE;
 	dev_ctx.humidity_attrs.max_measure_value = ZB_ZCL_REL_HUMIDITY_MEASUREMENT_MAX_VALUE_DEFAULT_VALUE;
 
 	/* onOff */
 	dev_ctx.on_off_attrs.on_off = ZB_ZCL_ON_OFF_IS_ON;
+
+	/* contact, the resumed state after a warm restart */
+	dev_ctx.contact_attrs.out_of_service = ZB_FALSE;
+	dev_ctx.contact_attrs.present_value = sent_hall_state ? ZB_TRUE : ZB_FALSE;
+	dev_ctx.contact_attrs.status_flags = ZB_ZCL_BINARY_INPUT_STATUS_FLAG_NORMAL;
 }
 
 //---------------------------------------------------------------------------------------------
@@ -735,6 +1255,8 @@ static void button_handler(uint32_t button_state, uint32_t has_changed)
 		if (!was_factory_reset_done ()) {
 			// Button released before Factory Reset, Start identification mode
 			ZB_SCHEDULE_APP_CALLBACK (start_identifying, 0);
+		} else {
+			ZB_SCHEDULE_APP_CALLBACK (show_factory_reset, 0);
 		}
 	}
 }
@@ -753,10 +1275,15 @@ static void start_identifying (zb_bufid_t bufid){
 		if (dev_ctx.identify_attr.identify_time ==
 		    ZB_ZCL_IDENTIFY_IDENTIFY_TIME_DEFAULT_VALUE) {
 
+#ifdef CONFIG_ZICADA_FB_INITIATOR
+			// bind the On/Off client to the lights that identify right now
+			zb_ret_t zb_err_code = zb_bdb_finding_binding_initiator(SOURCE_ENDPOINT, finding_binding_cb);
+#else
 			zb_ret_t zb_err_code = zb_bdb_finding_binding_target(SOURCE_ENDPOINT);
+#endif
 
 			if (zb_err_code == RET_OK) {
-				LOG_INF("Enter identify mode");
+				LOG_INF(IS_ENABLED(CONFIG_ZICADA_FB_INITIATOR) ? "Finding devices to bind" : "Enter identify mode");
 			} else if (zb_err_code == RET_INVALID_STATE) {
 				LOG_WRN("RET_INVALID_STATE - Cannot enter identify mode");
 			} else {
@@ -771,36 +1298,63 @@ static void start_identifying (zb_bufid_t bufid){
 	}
 }
 
+#ifdef CONFIG_ZICADA_FB_INITIATOR
+
+//---------------------------------------------------------------------------------------------
+// finding & binding initiator callback, called for each matching cluster of a target
+//
+
+static zb_bool_t finding_binding_cb (zb_int16_t status, zb_ieee_addr_t addr, zb_uint8_t ep, zb_uint16_t cluster){
+
+	ZVUNUSED(addr);
+
+	if (status == ZB_BDB_COMM_BIND_ASK_USER) {
+		// only the contact command is meant for the targets, their reports go elsewhere
+		return (cluster == ZB_ZCL_CLUSTER_ID_ON_OFF) ? ZB_TRUE : ZB_FALSE;
+	}
+	if (status == ZB_BDB_COMM_BIND_SUCCESS) {
+		LOG_INF("Bound cluster 0x%04x to endpoint %d", cluster, ep);
+	} else {
+		LOG_WRN("Binding cluster 0x%04x to endpoint %d failed", cluster, ep);
+	}
+	return ZB_TRUE;
+}
+
+#endif // CONFIG_ZICADA_FB_INITIATOR
+
 //---------------------------------------------------------------------------------------------
 // identify callback
 // 
 
 static void identify_cb (zb_bufid_t bufid){
 
-	zb_ret_t zb_err_code;
-
 	if (bufid) {
-		/* Schedule a self-scheduling function that will toggle the LED. */
-		ZB_SCHEDULE_APP_CALLBACK(toggle_identify_led, bufid);
+		/* Blink the LED in hardware until identify ends. */
+		led_pattern_play(LED_PATTERN_IDENTIFY);
 	} else {
-		/* Cancel the toggling function alarm and turn off LED. */
-		zb_err_code = ZB_SCHEDULE_APP_ALARM_CANCEL(toggle_identify_led, ZB_ALARM_ANY_PARAM);
-		ZVUNUSED(zb_err_code);
-
 		/* Update network status/idenitfication LED. */
-		if (ZB_JOINED()) {
-			dk_set_led_off(ZIGBEE_NETWORK_STATE_LED);
-		} else {
-			dk_set_led_on(ZIGBEE_NETWORK_STATE_LED);
-		}
+		led_pattern_set_base(!ZB_JOINED());
+		led_pattern_stop();
 	}
 }
 
+//---------------------------------------------------------------------------------------------
+// endpoint handler, sees every ZCL frame for the endpoint before the stack handles it
+//
+
+static zb_uint8_t zcl_ep_handler (zb_bufid_t bufid){
+
+	if (timebase_zcl_handler(bufid)) return ZB_TRUE;
+
+	// everything else is processed by the stack
+	return ZB_FALSE;
+}
+
 //---------------------------------------------------------------------------------------------
 // send contact on off command
 //
 
-static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id){
+static void contact_send_direct (zb_bufid_t bufid, zb_uint16_t cmd_id, zb_callback_t confirm){
 
 	ZB_ZCL_ON_OFF_SEND_REQ(bufid,
 		dest_ctx.short_addr,
@@ -810,21 +1364,91 @@ static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id){
 		ZB_AF_HA_PROFILE_ID,
 		ZB_ZCL_DISABLE_DEFAULT_RESPONSE,
 		cmd_id,
-		NULL);
+		confirm);
 }
 
-//---------------------------------------------------------------------------------------------
-// toggle identify led
-//
+#ifdef CONFIG_ZICADA_BINDING
+
+static void bind_coordinator_cb (zb_bufid_t bufid){
+
+	zb_zdo_bind_resp_t *resp = (zb_zdo_bind_resp_t *)zb_buf_begin(bufid);
+
+	if (resp->status == ZB_ZDP_STATUS_SUCCESS) LOG_DBG("On/Off client bound to the coordinator");
+	else LOG_WRN("Binding the On/Off client to the coordinator failed: %d", resp->status);
+	zb_buf_free(bufid);
+}
+
+// bind the On/Off client to the coordinator in the local binding table, an existing entry
+// is kept as it is. A bound send goes only to the bound devices, so without this entry the
+// coordinator would lose the contact command as soon as a light is bound.
+static void bind_coordinator (zb_bufid_t bufid){
+
+	zb_zdo_bind_req_param_t *req = ZB_BUF_GET_PARAM(bufid, zb_zdo_bind_req_param_t);
+
+	memset(req, 0, sizeof(*req));
+	if (zb_address_ieee_by_short(dest_ctx.short_addr, req->dst_address.addr_long) != RET_OK) {
+		LOG_WRN("Coordinator address unknown, On/Off client not bound to it");
+		zb_buf_free(bufid);
+		return;
+	}
+	zb_get_long_address(req->src_address);
+	req->src_endp = SOURCE_ENDPOINT;
+	req->cluster_id = ZB_ZCL_CLUSTER_ID_ON_OFF;
+	req->dst_addr_mode = ZB_APS_ADDR_MODE_64_ENDP_PRESENT;
+	req->dst_endp = dest_ctx.endpoint;
+	req->req_dst_addr = zb_get_short_address();
+
+	if (zb_zdo_bind_req(bufid, bind_coordinator_cb) == ZB_ZDO_INVALID_TSN) {
+		LOG_ERR("Failed to bind the On/Off client to the coordinator");
+		zb_buf_free(bufid);
+	}
+}
+
+// command and delivery confirm of the bound send in flight (one at a time, see delivery.c)
+static zb_uint16_t bound_cmd_id;
+static zb_callback_t bound_confirm;
+
+static void contact_bound_cb (zb_bufid_t bufid){
+
+	zb_zcl_command_send_status_t *send_status = ZB_BUF_GET_PARAM(bufid, zb_zcl_command_send_status_t);
+
+	if (send_status->status == RET_OK) {
+		bound_confirm(bufid);
+		return;
+	}
+
+	// nothing bound to the On/Off client (or no bound device took it), the coordinator still
+	// gets the command as without bindings, e.g. before bind_coordinator() took effect
+	LOG_DBG("Bound On/Off send failed (%d), sending to the coordinator", send_status->status);
+	contact_send_direct(bufid, bound_cmd_id, bound_confirm);
+}
+
+static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id, zb_callback_t confirm){
+
+	// the APS layer sends the command to every device and group bound to the On/Off client,
+	// a bound light switches without a detour through the coordinator
+	bound_cmd_id = cmd_id;
+	bound_confirm = confirm;
+	ZB_ZCL_ON_OFF_SEND_REQ(bufid,
+		0,
+		ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT,
+		0,
+		SOURCE_ENDPOINT,
+		ZB_AF_HA_PROFILE_ID,
+		ZB_ZCL_DISABLE_DEFAULT_RESPONSE,
+		cmd_id,
+		contact_bound_cb);
+}
 
-static void toggle_identify_led (zb_bufid_t bufid){
+#else
 
-	static int blink_status;
+static void contact_send_on_off (zb_bufid_t bufid, zb_uint16_t cmd_id, zb_callback_t confirm){
 
-	dk_set_led(ZIGBEE_NETWORK_STATE_LED, (++blink_status) % 2);
-	ZB_SCHEDULE_APP_ALARM(toggle_identify_led, bufid, ZB_MILLISECONDS_TO_BEACON_INTERVAL(100));
+	contact_send_direct(bufid, cmd_id, confirm);
 }
 
+#endif // CONFIG_ZICADA_BINDING
+
 //---------------------------------------------------------------------------------------------
 // Hall sensor interrupt callback
 //
@@ -841,10 +1465,12 @@ static void hall_sensor_interrupt_callback(const struct device *dev, struct gpio
     if (new_state != current_hall_state) {
         current_hall_state = new_state;
         
-        // Schedule the command sending
+        // Schedule the command sending, supervised until it ran
+        wdt_sup_arm(WDT_SUP_CONTACT);
         zb_ret_t zb_err = ZB_SCHEDULE_APP_CALLBACK(check_hall_sensor_and_send_command, 0);
         if (zb_err) {
             LOG_ERR("Failed to schedule hall sensor callback: %d", zb_err);
+            res_stats_fail(RES_STATS_SCHED);
         }
     }
 
@@ -864,73 +1490,54 @@ static void hall_sensor_interrupt_callback(const struct device *dev, struct gpio
 
 static void check_hall_sensor_and_send_command(zb_bufid_t bufid){
 
-    static bool previous_state = false;
     bool current_state = gpio_pin_get_dt(&hall_sensor);
+
+    wdt_sup_checkin(WDT_SUP_CONTACT);
+    wdt_sup_disarm(WDT_SUP_CONTACT);
     
     // Only act on state changes
-    if (current_state != previous_state) {
+    if (current_state != sent_hall_state) {
         zb_uint16_t cmd_id;
         zb_ret_t zb_err_code;
 
-		// Always cancel any existing LED alarm first
-        ZB_SCHEDULE_APP_ALARM_CANCEL(turn_off_led, ZB_ALARM_ANY_PARAM);
-        
-        // Turn on LED for indication
-        dk_set_led_on(ZIGBEE_NETWORK_STATE_LED);
-
-		// Schedule LED to turn off
-        zb_err_code = ZB_SCHEDULE_APP_ALARM(
-            turn_off_led, 0,
-            ZB_MILLISECONDS_TO_BEACON_INTERVAL(CONTACT_LED_INDICATION_DURATION_MSEC)
-		);
+		// Flash the LED for indication, it returns to the network state LED by itself
+        led_pattern_play(LED_PATTERN_CONTACT);
         
         if (current_state) {
             // Hall sensor activated (contact closed): send OFF command
             cmd_id = ZB_ZCL_CMD_ON_OFF_OFF_ID;
-            LOG_INF("Hall sensor activated - sending OFF command");
+            LOG_DBG("Hall sensor activated - sending OFF command");
         } else {
             // Hall sensor deactivated (contact opened): send ON command  
             cmd_id = ZB_ZCL_CMD_ON_OFF_ON_ID;
-            LOG_INF("Hall sensor deactivated - sending ON command");
+            LOG_DBG("Hall sensor deactivated - sending ON command");
         }
+        evt_log_put(EVT_CONTACT, current_state, cmd_id);
         
-        // Send the command
-        zb_err_code = zb_buf_get_out_delayed_ext(contact_send_on_off, cmd_id, 0);
-        ZB_ERROR_CHECK(zb_err_code);
-        
-        previous_state = current_state;
-    }
-}
+        // Send the command, repeated until acknowledged or replaced by the next change
+        zb_err_code = delivery_send(DELIVERY_CONTACT, contact_send_on_off, cmd_id);
+        if (zb_err_code) {
+            // counted and logged as dropped, the attribute report below still carries the state
+            LOG_ERR("Contact command dropped: %d", zb_err_code);
+        }
 
-//---------------------------------------------------------------------------------------------
-// Calculate battery level based on the cell voltage (from thunderboard react)
-//
+        // and keep the state readable, the attribute change is reported as well
+        zb_bool_t present_value = current_state ? ZB_TRUE : ZB_FALSE;
+        zb_zcl_status_t status = zb_zcl_set_attr_val(SOURCE_ENDPOINT, ZB_ZCL_CLUSTER_ID_BINARY_INPUT,
+            ZB_ZCL_CLUSTER_SERVER_ROLE, ZB_ZCL_ATTR_BINARY_INPUT_PRESENT_VALUE_ID,
+            (zb_uint8_t *)&present_value, ZB_FALSE);
+        if (status) {
+            LOG_ERR("Failed to set contact attribute: %d", status);
+            evt_log_put(EVT_ATTR_SET_FAILED, status, ZB_ZCL_CLUSTER_ID_BINARY_INPUT);
+        }
+        
+        sent_hall_state = current_state;
+        persist_get_warm()->hall_state = current_state;
+        persist_seal();
 
-uint8_t NiMH_CalculateLevel (uint16_t voltage){
-
-  uint32_t res = 0;
-  uint8_t i;
-
-  // Iterate through voltage/capacity table until correct interval is found.
-  // Then interpolate capacity within that interval based on a linear approximation
-  // between the capacity at the low and high end of the interval.
-  for (i = 0; i < (sizeof(vcPairs) / sizeof(voltage_capacity_pair_t)); i++) {
-    if (voltage > vcPairs[i].voltage) {
-      if (i == 0) {
-        // Higher than maximum voltage in table.
-        return vcPairs[0].capacity;
-      } else {
-        // Calculate the capacity by interpolation.
-        res = (voltage - vcPairs[i].voltage)
-              * (vcPairs[i - 1].capacity - vcPairs[i].capacity)
-              / (vcPairs[i - 1].voltage - vcPairs[i].voltage);
-        res += vcPairs[i].capacity;
-        return (uint8_t)res;
-      }
+        // the command and the attribute report wait for buffers now
+        res_stats_sample();
     }
-  }
-  // Below the minimum voltage in the table.
-  return vcPairs[sizeof(vcPairs) / sizeof(voltage_capacity_pair_t) - 1].capacity;
 }
 
 //---------------------------------------------------------------------------------------------
@@ -946,6 +1553,8 @@ static void attempt_rejoin(zb_bufid_t bufid){
 	} 
 	else{
 		LOG_INF("Waking up Zigbee Stack for rejoin.");
+		evt_log_put(EVT_REJOIN_ATTEMPT, 0, 0);
+		led_pattern_play(LED_PATTERN_JOINING);
 		user_input_indicate();
 
 		zb_ret_t zb_err = ZB_SCHEDULE_APP_ALARM(
@@ -953,19 +1562,22 @@ static void attempt_rejoin(zb_bufid_t bufid){
 		ZB_MILLISECONDS_TO_BEACON_INTERVAL(REJOIN_ATTEMPT_PERIOD_MSEC));
 		if (zb_err) {
 			LOG_ERR("Failed to schedule rejoin alarm: %d", zb_err);
+			res_stats_fail(RES_STATS_ALARM);
 		}
 		else LOG_INF("Scheduled next rejoin alarm in %ds", REJOIN_ATTEMPT_PERIOD_MSEC/1000);
 	}	
 }
 
 //---------------------------------------------------------------------------------------------
-// Turn off the LED via a timer
+// Show a completed factory reset on the LED
 //
 
-static void turn_off_led(zb_bufid_t bufid){
+static void show_factory_reset(zb_bufid_t bufid){
 
     ZVUNUSED(bufid);
-    // Restore network status LED state
-    if (ZB_JOINED()) dk_set_led_off(ZIGBEE_NETWORK_STATE_LED);
-    else dk_set_led_on(ZIGBEE_NETWORK_STATE_LED);
+    led_pattern_set_base(!ZB_JOINED());
+    led_pattern_play(LED_PATTERN_FACTORY_RESET);
+
+    // the values belong to the old network, don't resume them after the next reset
+    persist_invalidate();
 }
\ No newline at end of file
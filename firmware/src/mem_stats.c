@@ -0,0 +1,81 @@
+// Stack and heap high-water marks, see mem_stats.h
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/sys_heap.h>
+
+#include "mem_stats.h"
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+// thread names as set by the kernel, the logging subsystem and the ZBOSS platform
+static const char *const thread_names[MEM_STATS_THREAD_COUNT] = {
+	[MEM_STATS_ZBOSS]	= "zboss",
+	[MEM_STATS_MAIN]	= "main",
+	[MEM_STATS_LOG]		= "logging",
+	[MEM_STATS_WORKQ]	= "sysworkq",
+	[MEM_STATS_IDLE]	= "idle",
+};
+
+#if CONFIG_HEAP_MEM_POOL_SIZE > 0
+extern struct k_heap _system_heap;
+#endif
+
+static struct mem_stats stats;
+
+//---------------------------------------------------------------------------------------------
+// per thread stack scan
+//
+
+static void thread_scan(const struct k_thread *thread, void *user_data){
+
+	ARG_UNUSED(user_data);
+
+	const char *name = k_thread_name_get((k_tid_t)thread);
+	if (name == NULL) return;
+
+	for (int i = 0; i < MEM_STATS_THREAD_COUNT; i++) {
+		if (strcmp(name, thread_names[i])) continue;
+
+		size_t unused;
+		if (k_thread_stack_space_get(thread, &unused)) return;
+
+		stats.stack_size[i] = thread->stack_info.size;
+		stats.stack_used[i] = thread->stack_info.size - unused;
+		return;
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void mem_stats_update(void){
+
+	k_thread_foreach(thread_scan, NULL);
+
+#if CONFIG_HEAP_MEM_POOL_SIZE > 0
+	struct sys_memory_stats heap;
+	if (sys_heap_runtime_stats_get(&_system_heap.heap, &heap) == 0) {
+		stats.heap_size = heap.free_bytes + heap.allocated_bytes;
+		stats.heap_max_used = heap.max_allocated_bytes;
+	}
+#endif
+}
+
+const struct mem_stats *mem_stats_get(void){
+
+	return &stats;
+}
+
+void mem_stats_print(void){
+
+	for (int i = 0; i < MEM_STATS_THREAD_COUNT; i++) {
+		if (stats.stack_size[i] == 0) continue;
+		printk("MEM %s %u %u\n", thread_names[i], stats.stack_size[i], stats.stack_used[i]);
+	}
+	printk("MEM heap %u %u\n", stats.heap_size, stats.heap_max_used);
+}
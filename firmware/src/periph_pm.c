@@ -0,0 +1,136 @@
+// Peripheral power management, see periph_pm.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
+#include <drivers/include/nrfx_saadc.h>
+
+#include "periph_pm.h"
+#include "evt_log.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define NRFX_SAADC_CONFIG_IRQ_PRIORITY 6
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static const struct device *const i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c0));
+
+static K_MUTEX_DEFINE(pm_lock);
+
+static uint8_t refcount[PERIPH_PM_COUNT];
+static uint32_t active_since[PERIPH_PM_COUNT];
+static struct periph_pm_stats stats[PERIPH_PM_COUNT];
+
+//---------------------------------------------------------------------------------------------
+// per peripheral resume and suspend, called with pm_lock held on the 0 <-> 1 transitions
+//
+
+static int periph_resume(enum periph_pm_res res){
+
+	switch (res) {
+	case PERIPH_PM_I2C:
+		if (!IS_ENABLED(CONFIG_ZICADA_PM_I2C)) return 0;
+		return pm_device_runtime_get(i2c_dev);
+
+	case PERIPH_PM_SAADC:
+		return (nrfx_saadc_init(NRFX_SAADC_CONFIG_IRQ_PRIORITY) == NRFX_SUCCESS) ? 0 : -EIO;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+static int periph_suspend(enum periph_pm_res res){
+
+	switch (res) {
+	case PERIPH_PM_I2C:
+		if (!IS_ENABLED(CONFIG_ZICADA_PM_I2C)) return 0;
+		return pm_device_runtime_put(i2c_dev);
+
+	case PERIPH_PM_SAADC:
+		// shutdown adc to save power
+		nrfx_saadc_uninit();
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void periph_pm_init(void){
+
+	// the bus was left active by the sensor driver init, let runtime PM suspend it
+	if (IS_ENABLED(CONFIG_ZICADA_PM_I2C)) {
+		int err = pm_device_runtime_enable(i2c_dev);
+		if (err) LOG_ERR("Cannot enable runtime PM for i2c0 (err: %d)", err);
+	}
+}
+
+int periph_pm_get(enum periph_pm_res res){
+
+	int err = 0;
+
+	if (res >= PERIPH_PM_COUNT) return -EINVAL;
+
+	k_mutex_lock(&pm_lock, K_FOREVER);
+	if (refcount[res] == 0) {
+		err = periph_resume(res);
+		if (err) {
+			stats[res].errors++;
+			LOG_ERR("Cannot resume peripheral %d (err: %d)", res, err);
+		} else {
+			stats[res].activations++;
+			active_since[res] = k_uptime_get_32();
+			if (IS_ENABLED(CONFIG_ZICADA_PM_TRACE)) evt_log_put(EVT_PM_STATE, res, 1);
+		}
+	}
+	if (!err) refcount[res]++;
+	k_mutex_unlock(&pm_lock);
+
+	return err;
+}
+
+int periph_pm_put(enum periph_pm_res res){
+
+	int err = 0;
+
+	if (res >= PERIPH_PM_COUNT) return -EINVAL;
+
+	k_mutex_lock(&pm_lock, K_FOREVER);
+	if (refcount[res] == 0) {
+		err = -EALREADY;
+	} else if (--refcount[res] == 0) {
+		stats[res].active_ms += k_uptime_get_32() - active_since[res];
+		err = periph_suspend(res);
+		if (err) {
+			stats[res].errors++;
+			LOG_ERR("Cannot suspend peripheral %d (err: %d)", res, err);
+		}
+		if (IS_ENABLED(CONFIG_ZICADA_PM_TRACE)) evt_log_put(EVT_PM_STATE, res, 0);
+	}
+	k_mutex_unlock(&pm_lock);
+
+	return err;
+}
+
+void periph_pm_stats_get(enum periph_pm_res res, struct periph_pm_stats *out){
+
+	if (res >= PERIPH_PM_COUNT) return;
+
+	k_mutex_lock(&pm_lock, K_FOREVER);
+	*out = stats[res];
+	k_mutex_unlock(&pm_lock);
+}
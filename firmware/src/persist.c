@@ -0,0 +1,133 @@
+// Application state persisted in the ZBOSS NVRAM, see persist.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zboss_api.h>
+
+#include "persist.h"
+#include "retained.h"
+#include "res_stats.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+BUILD_ASSERT((sizeof(struct persist_data) % 4) == 0, "NVRAM datasets must be a multiple of 4 bytes");
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static __zicada_retained struct persist_snapshot snapshot;
+
+static int persist_write_dataset(void);
+
+// snapshot checks, NVRAM load and write decisions (persist_store.c)
+static struct persist_store store = {
+	.snapshot = &snapshot,
+	.write = persist_write_dataset,
+};
+
+//---------------------------------------------------------------------------------------------
+// NVRAM callbacks, called by the stack while loading or writing ZB_NVRAM_APP_DATA1
+//
+
+static zb_uint16_t persist_get_size(void){
+
+	return sizeof(snapshot.data);
+}
+
+static void persist_read(zb_uint8_t page, zb_uint32_t pos, zb_uint16_t payload_length){
+
+	struct persist_data data = { 0 };
+
+	// only a dataset of the expected size is read, the store decides whether it is taken
+	if (!store.warm_restored && (payload_length == sizeof(data)) &&
+	    (zb_nvram_read_data(page, pos, (zb_uint8_t *)&data, sizeof(data)) != RET_OK)) {
+		LOG_ERR("Failed to read persisted state");
+		return;
+	}
+
+	switch (persist_store_load(&store, &data, payload_length)) {
+	case PERSIST_LOAD_SIZE:
+		LOG_WRN("Persisted state has unexpected size %d, ignoring it", payload_length);
+		break;
+	case PERSIST_LOAD_VERSION:
+		LOG_WRN("Persisted state version %d not supported, ignoring it", data.version);
+		break;
+	default:
+		break;
+	}
+}
+
+static zb_ret_t persist_write(zb_uint8_t page, zb_uint32_t pos){
+
+	return zb_nvram_write_data(page, pos, (zb_uint8_t *)&snapshot.data, sizeof(snapshot.data));
+}
+
+static int persist_write_dataset(void){
+
+	return zb_nvram_write_dataset(ZB_NVRAM_APP_DATA1);
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void persist_init(bool warm){
+
+	if (persist_store_start(&store, warm) == PERSIST_START_CORRUPT) {
+		LOG_WRN("Retained snapshot is corrupt, starting cold");
+	}
+
+	zb_nvram_register_app1_read_cb(persist_read);
+	zb_nvram_register_app1_write_cb(persist_write, persist_get_size);
+}
+
+bool persist_restored(void){
+
+	return store.restored;
+}
+
+bool persist_warm_restored(void){
+
+	return store.warm_restored;
+}
+
+struct persist_warm *persist_get_warm(void){
+
+	return &snapshot.warm;
+}
+
+void persist_invalidate(void){
+
+	persist_store_invalidate(&store);
+}
+
+struct persist_data *persist_get(void){
+
+	return &snapshot.data;
+}
+
+void persist_seal(void){
+
+	persist_store_seal(&store);
+}
+
+void persist_mark(uint8_t parts){
+
+	persist_store_mark(&store, parts);
+}
+
+void persist_flush(void){
+
+	int err = persist_store_flush(&store, k_uptime_get());
+	if (err) {
+		LOG_ERR("Failed to write persisted state: %d", err);
+		res_stats_fail(RES_STATS_NVRAM);
+	}
+}
+
+const struct persist_stats *persist_get_stats(void){
+
+	return &store.stats;
+}
@@ -0,0 +1,71 @@
+// When the persisted state is worth an NVRAM write, see persist_policy.h
+//
+// Plain C without kernel dependencies so that it can also be built on a host.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "persist_policy.h"
+#include "zicada_params.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define PERSIST_SAVE_PERIOD_MSEC	((int64_t)CONFIG_ZICADA_PERSIST_SAVE_CYCLES * TEMP_HUMIDITY_CHECK_PERIOD_MSEC)
+
+//---------------------------------------------------------------------------------------------
+// true if the values moved far enough from the written ones to be worth a flash write
+//
+
+static bool values_changed(const struct persist_policy *p, const struct persist_data *data){
+
+	// the battery check phase is left out: it only shifts the first battery check after a
+	// power-on reset, by less than one battery check period
+	return (data->flags != p->written.flags) || (data->battery_percent != p->written.battery_percent) ||
+		(abs(data->temperature - p->written.temperature) >= CONFIG_ZICADA_PERSIST_MIN_CHANGE) ||
+		(abs(data->humidity - p->written.humidity) >= CONFIG_ZICADA_PERSIST_MIN_CHANGE);
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void persist_policy_init(struct persist_policy *p){
+
+	memset(p, 0, sizeof(*p));
+}
+
+void persist_policy_loaded(struct persist_policy *p, const struct persist_data *data){
+
+	p->written = *data;
+}
+
+void persist_policy_mark(struct persist_policy *p, uint8_t parts){
+
+	p->dirty |= parts;
+}
+
+enum persist_decision persist_policy_check(struct persist_policy *p, const struct persist_data *data,
+	int64_t now_ms){
+
+	if (!p->dirty) return PERSIST_WAIT;
+
+	// a changed reporting state goes out right away and takes the values along
+	bool config = (p->dirty & PERSIST_DIRTY_CONFIG) != 0;
+	if (!config && (now_ms - p->last_check < PERSIST_SAVE_PERIOD_MSEC)) return PERSIST_WAIT;
+	p->last_check = now_ms;
+
+	if (!config && !values_changed(p, data)) {
+		p->dirty = 0;
+		return PERSIST_SKIP;
+	}
+	return PERSIST_WRITE;
+}
+
+void persist_policy_result(struct persist_policy *p, const struct persist_data *data, bool ok){
+
+	if (!ok) return;
+	p->written = *data;
+	p->dirty = 0;
+}
@@ -0,0 +1,142 @@
+// Persisted state across resets and power loss, see persist_store.h
+//
+// Plain C without kernel dependencies so that it can also be built on a host.
+
+#include <stddef.h>
+#include <string.h>
+
+#include "persist_store.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// the sealed part of the snapshot
+#define SNAPSHOT_SEALED_OFFSET	offsetof(struct persist_snapshot, data)
+#define SNAPSHOT_SEALED_SIZE	(offsetof(struct persist_snapshot, crc) - SNAPSHOT_SEALED_OFFSET)
+
+//---------------------------------------------------------------------------------------------
+// snapshot checksum, a random block or one torn by a reset during an update fails it
+//
+
+// CRC-32 (IEEE 802.3), bitwise, the snapshot is only a few words
+static uint32_t snapshot_crc(const struct persist_snapshot *s){
+
+	const uint8_t *p = (const uint8_t *)s + SNAPSHOT_SEALED_OFFSET;
+	uint32_t crc = 0xFFFFFFFFUL;
+
+	for (size_t i = 0; i < SNAPSHOT_SEALED_SIZE; i++) {
+		crc ^= p[i];
+		for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+static void snapshot_reset(struct persist_snapshot *s){
+
+	memset(s, 0, sizeof(*s));
+	s->magic = PERSIST_SNAPSHOT_MAGIC;
+	s->data.version = PERSIST_VERSION;
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+enum persist_start persist_store_start(struct persist_store *st, bool warm){
+
+	struct persist_snapshot *s = st->snapshot;
+	enum persist_start start = PERSIST_START_COLD;
+
+	bool valid = (s->magic == PERSIST_SNAPSHOT_MAGIC) && (s->crc == snapshot_crc(s)) &&
+		(s->data.version == PERSIST_VERSION);
+
+	st->restored = false;
+	st->warm_restored = false;
+	memset(&st->stats, 0, sizeof(st->stats));
+	persist_policy_init(&st->policy);
+
+	if (warm && valid) {
+		s->warm.warm_restarts++;
+		// values are only worth restoring once reporting ran, like a dataset in NVRAM
+		if (s->data.flags & PERSIST_FLAG_REPORTING_CONFIGURED) {
+			start = PERSIST_START_WARM;
+			st->warm_restored = true;
+			st->restored = true;
+
+			// only what the flash does not have yet is written again
+			persist_policy_loaded(&st->policy, &s->written);
+			if (s->data.flags != s->written.flags) persist_policy_mark(&st->policy, PERSIST_DIRTY_CONFIG);
+			else if (memcmp(&s->data, &s->written, sizeof(s->data))) {
+				persist_policy_mark(&st->policy, PERSIST_DIRTY_VALUES);
+			}
+		} else {
+			start = PERSIST_START_RETAINED;
+		}
+	} else {
+		if (warm) start = PERSIST_START_CORRUPT;
+		snapshot_reset(s);
+	}
+	persist_store_seal(st);
+	return start;
+}
+
+enum persist_load persist_store_load(struct persist_store *st, const struct persist_data *data,
+	uint16_t length){
+
+	struct persist_snapshot *s = st->snapshot;
+
+	// the snapshot is at least as new as the dataset
+	if (st->warm_restored) return PERSIST_LOAD_IGNORED;
+	if (length != sizeof(*data)) return PERSIST_LOAD_SIZE;
+	if (data->version != PERSIST_VERSION) return PERSIST_LOAD_VERSION;
+
+	s->data = *data;
+	s->written = *data;
+	persist_store_seal(st);
+	persist_policy_loaded(&st->policy, data);
+	st->restored = true;
+	return PERSIST_LOAD_OK;
+}
+
+void persist_store_seal(struct persist_store *st){
+
+	st->snapshot->crc = snapshot_crc(st->snapshot);
+}
+
+void persist_store_mark(struct persist_store *st, uint8_t parts){
+
+	persist_store_seal(st);
+	persist_policy_mark(&st->policy, parts);
+}
+
+int persist_store_flush(struct persist_store *st, int64_t now_ms){
+
+	struct persist_snapshot *s = st->snapshot;
+
+	enum persist_decision decision = persist_policy_check(&st->policy, &s->data, now_ms);
+	if (decision == PERSIST_SKIP) st->stats.skipped++;
+	if (decision != PERSIST_WRITE) return 0;
+
+	// a failed write stays dirty, a later flush tries again
+	int err = st->write();
+	if (!err) {
+		st->stats.writes++;
+		s->written = s->data;
+		persist_store_seal(st);
+	}
+	persist_policy_result(&st->policy, &s->data, err == 0);
+	return err;
+}
+
+void persist_store_invalidate(struct persist_store *st){
+
+	struct persist_snapshot *s = st->snapshot;
+
+	// the counters in the retained-only part keep counting
+	memset(&s->data, 0, sizeof(s->data));
+	s->data.version = PERSIST_VERSION;
+	persist_store_seal(st);
+	st->restored = false;
+	st->warm_restored = false;
+}
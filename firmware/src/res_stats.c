@@ -0,0 +1,206 @@
+// ZBOSS resource headroom, see res_stats.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include <zboss_api.h>
+
+#include "res_stats.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// the probes hold what they take on the stack, pools beyond this are probed up to it
+#define RES_STATS_PROBE_MAX		64
+
+// an alarm far enough out never fires during a probe
+#define RES_STATS_PROBE_DELAY	(ZB_TIME_ONE_SECOND * 3600)
+
+// erase cycles of the nRF52840 flash, ZBOSS erases its NVRAM pages in turn
+#define RES_STATS_FLASH_ENDURANCE	10000
+
+#define RES_STATS_DAY_SEC		(60ULL * 60 * 24)
+
+//---------------------------------------------------------------------------------------------
+// ZBOSS osif NVRAM access, part of the platform but not of the public API headers
+//
+
+zb_uint8_t zb_get_nvram_page_count(void);
+zb_uint32_t zb_get_nvram_page_length(void);
+zb_ret_t zb_osif_nvram_read(zb_uint8_t page, zb_uint32_t pos, zb_uint8_t *buf, zb_uint16_t len);
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static const char *const res_names[RES_STATS_RES_COUNT] = {
+	[RES_STATS_SCHED]	= "sched_q",
+	[RES_STATS_ALARM]	= "alarm_q",
+	[RES_STATS_BUF_IN]	= "buf_in",
+	[RES_STATS_BUF_OUT]	= "buf_out",
+	[RES_STATS_NVRAM]	= "nvram",
+};
+
+static struct res_stats stats;
+static atomic_t fail_count[RES_STATS_RES_COUNT];
+
+static bool nvram_read;
+static uint32_t nvram_last_fill;
+
+//---------------------------------------------------------------------------------------------
+// probes
+//
+
+static void res_stats_noop(zb_uint8_t param){
+
+	ZVUNUSED(param);
+}
+
+// free buffers of one direction
+static uint32_t probe_buffers(zb_bool_t is_in, uint32_t limit){
+
+	zb_bufid_t held[RES_STATS_PROBE_MAX];
+	uint32_t n = 0;
+
+	limit = MIN(limit, RES_STATS_PROBE_MAX);
+	while (n < limit) {
+		zb_bufid_t bufid = zb_buf_get(is_in, 0);
+		if (bufid == ZB_BUF_INVALID) break;
+		held[n++] = bufid;
+	}
+	for (uint32_t i = 0; i < n; i++) {
+		zb_buf_free(held[i]);
+	}
+	return n;
+}
+
+// free alarm entries
+static uint32_t probe_alarms(uint32_t limit){
+
+	uint32_t n = 0;
+
+	limit = MIN(limit, RES_STATS_PROBE_MAX);
+	while (n < limit) {
+		if (ZB_SCHEDULE_APP_ALARM(res_stats_noop, 0, RES_STATS_PROBE_DELAY) != RET_OK) break;
+		n++;
+	}
+	ZB_SCHEDULE_APP_ALARM_CANCEL(res_stats_noop, ZB_ALARM_ALL_CB);
+	return n;
+}
+
+static void keep_min(enum res_stats_res res, uint32_t free){
+
+	if (free < stats.min_free[res]) stats.min_free[res] = free;
+}
+
+// bytes in use of the fullest NVRAM page, the free part of a page is erased flash at its end
+static uint32_t nvram_max_fill(void){
+
+	uint8_t chunk[32];
+	uint32_t length = zb_get_nvram_page_length();
+	uint32_t max_fill = 0;
+
+	for (uint8_t page = 0; page < zb_get_nvram_page_count(); page++) {
+		uint32_t fill = 0;
+		for (uint32_t end = length; end > 0 && fill == 0; ) {
+			uint32_t pos = (end > sizeof(chunk)) ? end - sizeof(chunk) : 0;
+			if (zb_osif_nvram_read(page, pos, chunk, end - pos) != RET_OK) return max_fill;
+			for (uint32_t i = end - pos; i > 0; i--) {
+				if (chunk[i - 1] != 0xFF) {
+					fill = pos + i;
+					break;
+				}
+			}
+			end = pos;
+		}
+		max_fill = MAX(max_fill, fill);
+	}
+	return max_fill;
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void res_stats_init(uint32_t sched_q_size, uint32_t iobuf_pool_size){
+
+	stats.size[RES_STATS_SCHED] = sched_q_size;
+	stats.size[RES_STATS_ALARM] = sched_q_size;
+	// each direction may take half of the shared pool
+	stats.size[RES_STATS_BUF_IN] = iobuf_pool_size / 2;
+	stats.size[RES_STATS_BUF_OUT] = iobuf_pool_size / 2;
+	stats.size[RES_STATS_NVRAM] = zb_get_nvram_page_length();
+
+	for (int i = 0; i < RES_STATS_RES_COUNT; i++) {
+		stats.min_free[i] = stats.size[i];
+	}
+}
+
+void res_stats_sample(void){
+
+	// all of these run without giving the stack a turn, it never sees the pools empty
+	keep_min(RES_STATS_BUF_IN, probe_buffers(ZB_TRUE, stats.size[RES_STATS_BUF_IN]));
+	keep_min(RES_STATS_BUF_OUT, probe_buffers(ZB_FALSE, stats.size[RES_STATS_BUF_OUT]));
+	keep_min(RES_STATS_ALARM, probe_alarms(stats.size[RES_STATS_ALARM]));
+}
+
+// write rate and page erases from the fill of the active page
+static void nvram_wear(uint32_t fill){
+
+	uint32_t page = stats.size[RES_STATS_NVRAM];
+
+	if (nvram_read) {
+		if (fill >= nvram_last_fill) {
+			stats.nvram_written += fill - nvram_last_fill;
+		} else {
+			// the page ran full, ZBOSS moved the datasets to the next page and erased this
+			// one (the copied datasets count as written, they wear the new page as well)
+			stats.nvram_erases++;
+			stats.nvram_written += (page - nvram_last_fill) + fill;
+		}
+	}
+	nvram_read = true;
+	nvram_last_fill = fill;
+
+	// every page is erased once per page size written
+	uint64_t uptime = k_uptime_get() / 1000;
+	uint64_t flash = (uint64_t)page * zb_get_nvram_page_count() * RES_STATS_FLASH_ENDURANCE;
+	if (stats.nvram_written == 0) {
+		stats.nvram_lifetime = UINT16_MAX;
+	} else {
+		uint64_t days = (flash * uptime) / ((uint64_t)stats.nvram_written * RES_STATS_DAY_SEC);
+		stats.nvram_lifetime = (uint16_t)MIN(days, UINT16_MAX);
+	}
+}
+
+void res_stats_update(void){
+
+	uint32_t fill = nvram_max_fill();
+	keep_min(RES_STATS_NVRAM, stats.size[RES_STATS_NVRAM] - MIN(fill, stats.size[RES_STATS_NVRAM]));
+	nvram_wear(fill);
+
+	for (int i = 0; i < RES_STATS_RES_COUNT; i++) {
+		stats.failures[i] = (uint16_t)MIN(atomic_get(&fail_count[i]), UINT16_MAX);
+	}
+}
+
+void res_stats_fail(enum res_stats_res res){
+
+	if (res < RES_STATS_RES_COUNT) atomic_inc(&fail_count[res]);
+}
+
+const struct res_stats *res_stats_get(void){
+
+	return &stats;
+}
+
+void res_stats_print(void){
+
+	for (int i = 0; i < RES_STATS_RES_COUNT; i++) {
+		printk("RES %s %u %u %u\n", res_names[i], stats.size[i], stats.min_free[i], stats.failures[i]);
+	}
+	printk("NVRAM wear: %u bytes written, %u page erases, lifetime %u days\n",
+		stats.nvram_written, stats.nvram_erases, stats.nvram_lifetime);
+}
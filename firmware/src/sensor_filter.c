@@ -0,0 +1,97 @@
+// Sensor signal conditioning, see sensor_filter.h
+//
+// Plain C without kernel dependencies so that it can also be built on a host.
+
+#include <stddef.h>
+
+#include "sensor_filter.h"
+
+//---------------------------------------------------------------------------------------------
+// reset a filter
+//
+
+void sensor_filter_init(struct sensor_filter *f, const struct sensor_filter_cfg *cfg){
+
+	f->cfg = cfg;
+	f->ema = 0;
+	f->last = 0;
+	f->rejects = 0;
+	f->seeded = false;
+	f->rejected = 0;
+	f->accepted = 0;
+}
+
+//---------------------------------------------------------------------------------------------
+// median of a burst (insertion sort, n is small)
+//
+
+int32_t sensor_filter_median(int32_t *samples, uint8_t n){
+
+	if (n == 0) return 0;
+	if (n > SENSOR_FILTER_MAX_BURST) n = SENSOR_FILTER_MAX_BURST;
+
+	for (uint8_t i = 1; i < n; i++) {
+		int32_t v = samples[i];
+		uint8_t j = i;
+		while ((j > 0) && (samples[j - 1] > v)) {
+			samples[j] = samples[j - 1];
+			j--;
+		}
+		samples[j] = v;
+	}
+
+	// even bursts: mean of the two middle samples
+	if ((n & 1) == 0) return (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	return samples[n / 2];
+}
+
+//---------------------------------------------------------------------------------------------
+// plausibility gate and EMA smoothing
+//
+
+bool sensor_filter_update(struct sensor_filter *f, int32_t sample, int32_t *out){
+
+	const struct sensor_filter_cfg *cfg = f->cfg;
+
+	// outside of the sensor range: I2C glitch or broken sensor, never accepted
+	if ((sample < cfg->min) || (sample > cfg->max)) {
+		f->rejected++;
+		return false;
+	}
+
+	bool step_change = false;
+
+	if (f->seeded && (cfg->max_step > 0)) {
+		int32_t step = sample - f->last;
+		if (step < 0) step = -step;
+
+		// a single implausible jump is dropped, a persistent one is a real change
+		if (step > cfg->max_step) {
+			if (f->rejects < cfg->max_rejects) {
+				f->rejects++;
+				f->rejected++;
+				return false;
+			}
+			step_change = true;
+		}
+	}
+
+	f->rejects = 0;
+	f->last = sample;
+	f->accepted++;
+
+	// (re)seed on the first sample and after a step change that passed the gate late
+	int32_t sample_q = sample * (1 << SENSOR_FILTER_EMA_FRAC);
+	if (!f->seeded || step_change || (cfg->ema_shift == 0)) {
+		f->ema = sample_q;
+		f->seeded = true;
+	} else {
+		f->ema += (sample_q - f->ema) / (1 << cfg->ema_shift);
+	}
+
+	// round to nearest
+	int32_t half = 1 << (SENSOR_FILTER_EMA_FRAC - 1);
+	*out = (f->ema >= 0) ? ((f->ema + half) >> SENSOR_FILTER_EMA_FRAC) :
+		-((-f->ema + half) >> SENSOR_FILTER_EMA_FRAC);
+	return true;
+}
@@ -0,0 +1,255 @@
+// Wall-clock time from the coordinator's Time cluster, see timebase.h
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zboss_api.h>
+
+#include "timebase.h"
+#include "evt_log.h"
+#include "persist.h"
+#include "delivery.h"
+#include "app_sched.h"
+#include "zicada_params.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// the Time cluster server on endpoint 1 of the coordinator
+#define TIMEBASE_DEST_SHORT_ADDR	0x0000
+#define TIMEBASE_DEST_ENDPOINT		1
+#define TIMEBASE_SOURCE_ENDPOINT	1
+
+// the Time attribute is truncated to whole seconds, the true time is up to 1 s later
+#define TIMEBASE_ROUNDING_MS		500
+
+// a larger error at a sync is a clock change on the coordinator, not drift
+#define TIMEBASE_STEP_MS			(1000 * 60)
+
+// an answer after this no longer belongs to the request time
+#define TIMEBASE_RESPONSE_TIMEOUT_MS	(1000 * 30)
+
+// the drift is measured over at least one minimum interval, the 1 s resolution of the
+// Time attribute is then below 70 ppm and averages out over the following syncs
+#define TIMEBASE_DRIFT_SPAN_MS		TIME_SYNC_MIN_INTERVAL_MSEC
+
+#define TIMEBASE_ACCURACY_MS		CONFIG_ZICADA_TIMEBASE_ACCURACY_MS
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+// uptime and UTC at one instant, both in ms
+struct sync_point {
+	int64_t uptime;
+	int64_t utc;
+};
+
+static bool synced;
+static bool pending;
+static struct sync_point anchor;	// start of the running drift measurement
+static struct sync_point last;		// latest sync, the time is projected from here
+static int32_t drift_ppm;			// LF clock is slow by this much (UTC runs faster)
+static bool drift_measured;
+static int32_t last_error_ms;		// error of the local time found at the latest sync
+static uint32_t interval_ms = TIME_SYNC_MIN_INTERVAL_MSEC;
+static int64_t next_sync;			// uptime of the next sync, 0 = with the next poll
+static int64_t request_uptime;
+
+//---------------------------------------------------------------------------------------------
+// local time projection
+//
+
+static int64_t project(int64_t uptime){
+
+	int64_t elapsed = uptime - last.uptime;
+	return last.utc + elapsed + (elapsed * drift_ppm) / 1000000;
+}
+
+//---------------------------------------------------------------------------------------------
+// a Time attribute arrived for the request sent at request_uptime
+//
+
+static void timebase_sync(uint32_t utc_sec){
+
+	// the coordinator read its clock shortly after the request went out, the delivery of
+	// the answer (up to the next parent poll) does not matter
+	struct sync_point now = {
+		.uptime = request_uptime,
+		.utc = (int64_t)utc_sec * 1000 + TIMEBASE_ROUNDING_MS,
+	};
+	int64_t err = 0;
+
+	if (!synced) {
+		anchor = now;
+		interval_ms = TIME_SYNC_MIN_INTERVAL_MSEC;
+		synced = true;
+	} else {
+		err = now.utc - project(now.uptime);
+
+		if (llabs(err) > TIMEBASE_STEP_MS) {
+			// the coordinator's clock was set, keep the drift and measure from here
+			LOG_WRN("Coordinator time stepped by %d s", (int)(err / 1000));
+			anchor = now;
+			interval_ms = TIME_SYNC_MIN_INTERVAL_MSEC;
+			err = 0;
+		} else {
+			int64_t span = now.uptime - anchor.uptime;
+			if (span >= TIMEBASE_DRIFT_SPAN_MS) {
+				int32_t measured = (int32_t)(((now.utc - anchor.utc - span) * 1000000) / span);
+				// each span is a fresh measurement, the average follows temperature changes of
+				// an RC oscillator while the rounding error of single spans cancels out
+				drift_ppm = drift_measured ? (drift_ppm + measured) / 2 : measured;
+				drift_measured = true;
+				anchor = now;
+			}
+
+			interval_ms = app_sched_sync_interval(interval_ms, (int32_t)err, TIMEBASE_ACCURACY_MS);
+		}
+	}
+
+	last = now;
+	last_error_ms = (int32_t)err;
+	next_sync = now.uptime + interval_ms;
+	struct persist_warm *warm = persist_get_warm();
+	warm->lf_drift_ppm = (int16_t)CLAMP(drift_ppm, INT16_MIN, INT16_MAX);
+	if (drift_measured) warm->flags |= PERSIST_WARM_DRIFT_MEASURED;
+	persist_seal();
+
+	LOG_INF("Time synced: %u s, error %d ms, drift %d ppm, next sync in %u s",
+		utc_sec, (int)err, drift_ppm, interval_ms / 1000);
+	evt_log_put(EVT_TIME_SYNC, (int16_t)CLAMP(drift_ppm, INT16_MIN, INT16_MAX), (int32_t)utc_sec);
+}
+
+//---------------------------------------------------------------------------------------------
+// read the Time attribute of the coordinator
+//
+
+static void timebase_send_request(zb_bufid_t bufid, zb_uint16_t arg, zb_callback_t confirm){
+
+	zb_uint8_t *cmd_ptr;
+	zb_uint16_t dst_addr = TIMEBASE_DEST_SHORT_ADDR;
+
+	ZVUNUSED(arg);
+
+	ZB_ZCL_GENERAL_INIT_READ_ATTR_REQ(bufid, cmd_ptr, ZB_ZCL_DISABLE_DEFAULT_RESPONSE);
+	ZB_ZCL_GENERAL_ADD_ID_READ_ATTR_REQ(cmd_ptr, ZB_ZCL_ATTR_TIME_TIME_ID);
+
+	request_uptime = k_uptime_get();
+	pending = true;
+
+	ZB_ZCL_GENERAL_SEND_READ_ATTR_REQ(bufid, cmd_ptr, dst_addr, ZB_APS_ADDR_MODE_16_ENDP_PRESENT,
+		TIMEBASE_DEST_ENDPOINT, TIMEBASE_SOURCE_ENDPOINT, ZB_AF_HA_PROFILE_ID,
+		ZB_ZCL_CLUSTER_ID_TIME, confirm);
+
+#if defined(CONFIG_ZIGBEE_ROLE_END_DEVICE)
+	// fetch the answer from the parent now instead of with the next long poll
+	zb_zdo_pim_start_turbo_poll_packets(1);
+#endif
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void timebase_init(void){
+
+	// cleared after a power-on reset, the measurement starts over. A measured drift of
+	// exactly 0 ppm is still a measurement.
+	const struct persist_warm *warm = persist_get_warm();
+	drift_measured = (warm->flags & PERSIST_WARM_DRIFT_MEASURED) != 0;
+	drift_ppm = drift_measured ? warm->lf_drift_ppm : 0;
+}
+
+void timebase_poll(void){
+
+	int64_t now = k_uptime_get();
+
+	if (pending) {
+		if (now - request_uptime < TIMEBASE_RESPONSE_TIMEOUT_MS) return;
+		LOG_WRN("No answer to the time request");
+		pending = false;
+		next_sync = now + TIME_SYNC_RETRY_MSEC;
+	}
+
+	if (!ZB_JOINED() || (now < next_sync)) return;
+
+	// best effort, an unanswered request is tried again after TIME_SYNC_RETRY_MSEC
+	zb_ret_t err = delivery_send(DELIVERY_TIME, timebase_send_request, 0);
+	if (err) {
+		LOG_ERR("Failed to send the time request: %d", err);
+	}
+}
+
+zb_uint8_t timebase_zcl_handler(zb_bufid_t bufid){
+
+	zb_zcl_parsed_hdr_t *cmd_info = ZB_BUF_GET_PARAM(bufid, zb_zcl_parsed_hdr_t);
+
+	if ((cmd_info->cluster_id != ZB_ZCL_CLUSTER_ID_TIME) || !cmd_info->is_common_command ||
+	    (cmd_info->cmd_direction != ZB_ZCL_FRAME_DIRECTION_TO_CLI)) {
+		return ZB_FALSE;
+	}
+
+	if (cmd_info->cmd_id == ZB_ZCL_CMD_READ_ATTRIB_RESP) {
+		zb_zcl_read_attr_res_t *res;
+		bool found = false;
+
+		ZB_ZCL_GENERAL_GET_NEXT_READ_ATTR_RES(bufid, res);
+		while (res) {
+			if ((res->attr_id == ZB_ZCL_ATTR_TIME_TIME_ID) && (res->status == ZB_ZCL_STATUS_SUCCESS)) {
+				zb_uint32_t utc_sec;
+				ZB_LETOH32(&utc_sec, res->attr_value);
+				// 0xFFFFFFFF is an invalid time, 0 a coordinator that never set its clock
+				if (pending && (utc_sec != 0) && (utc_sec != ZB_UINT32_MAX)) {
+					timebase_sync(utc_sec);
+					found = true;
+				}
+			}
+			ZB_ZCL_GENERAL_GET_NEXT_READ_ATTR_RES(bufid, res);
+		}
+		if (pending && !found) {
+			// no usable time, ask rarely
+			LOG_WRN("Coordinator has no valid time");
+			next_sync = k_uptime_get() + TIME_SYNC_MAX_INTERVAL_MSEC;
+		}
+	} else if (cmd_info->cmd_id == ZB_ZCL_CMD_DEFAULT_RESP) {
+		// no Time cluster on the coordinator
+		zb_zcl_default_resp_payload_t *resp = ZB_ZCL_READ_DEFAULT_RESP(bufid);
+		LOG_WRN("Time request failed: status %d", resp ? resp->status : -1);
+		next_sync = k_uptime_get() + TIME_SYNC_MAX_INTERVAL_MSEC;
+	} else {
+		return ZB_FALSE;
+	}
+
+	pending = false;
+	zb_buf_free(bufid);
+	return ZB_TRUE;
+}
+
+bool timebase_now(int64_t *utc_ms){
+
+	if (!synced) return false;
+	*utc_ms = project(k_uptime_get());
+	return true;
+}
+
+bool timebase_drift(int32_t *ppm, int32_t *error_ms){
+
+	if (!drift_measured) return false;
+	*ppm = drift_ppm;
+	*error_ms = last_error_ms;
+	return true;
+}
+
+bool timebase_uptime_at(int64_t utc_ms, int64_t *uptime_ms){
+
+	if (!synced) return false;
+	// inverse of project()
+	int64_t delta = utc_ms - last.utc;
+	*uptime_ms = last.uptime + (delta * 1000000) / (1000000 + drift_ppm);
+	return true;
+}
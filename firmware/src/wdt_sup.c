@@ -0,0 +1,185 @@
+// Watchdog supervision, see wdt_sup.h
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/watchdog.h>
+#include <zephyr/logging/log.h>
+
+#include <zboss_api.h>
+
+#include "wdt_sup.h"
+#include "evt_log.h"
+#include "res_stats.h"
+#include "zicada_params.h"
+
+LOG_MODULE_DECLARE(app, LOG_LEVEL_INF);
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define WDT_TIMEOUT_MSEC			(1000U * CONFIG_ZICADA_WATCHDOG_TIMEOUT_SEC)
+
+// fires only if nothing else checked in for half the timeout
+#define WDT_HEARTBEAT_MSEC			(WDT_TIMEOUT_MSEC / 2)
+
+// a contact change is queued to the Zigbee thread straight from the interrupt
+#define WDT_CONTACT_DEADLINE_MSEC	(1000 * 10)
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+static const struct device *const wdt = DEVICE_DT_GET(DT_ALIAS(watchdog0));
+
+// longest time an armed task may go without a check-in
+static const uint32_t deadline[WDT_SUP_TASK_COUNT] = {
+	[WDT_SUP_ZIGBEE]	= WDT_TIMEOUT_MSEC,
+	[WDT_SUP_SENSOR]	= 2 * TEMP_HUMIDITY_CHECK_PERIOD_MSEC,	// one late check is tolerated
+	[WDT_SUP_CONTACT]	= WDT_CONTACT_DEADLINE_MSEC,
+};
+
+static int channel = -1;
+static uint8_t armed;
+static uint8_t late;		// tasks already logged as late
+static uint32_t last_checkin[WDT_SUP_TASK_COUNT];
+
+//---------------------------------------------------------------------------------------------
+// heartbeat alarm, keeps the Zigbee thread supervised when no other task checks in
+//
+
+static void wdt_sup_heartbeat(zb_bufid_t bufid){
+
+	ZVUNUSED(bufid);
+
+	wdt_sup_checkin(WDT_SUP_ZIGBEE);
+}
+
+// every check-in pushes the heartbeat out, so it costs no wake-up while the periodic
+// checks run
+static void schedule_heartbeat(void){
+
+	ZB_SCHEDULE_APP_ALARM_CANCEL(wdt_sup_heartbeat, ZB_ALARM_ANY_PARAM);
+
+	zb_ret_t err = ZB_SCHEDULE_APP_ALARM(wdt_sup_heartbeat, 0,
+		ZB_MILLISECONDS_TO_BEACON_INTERVAL(WDT_HEARTBEAT_MSEC));
+	if (err) {
+		LOG_ERR("Failed to schedule watchdog heartbeat alarm: %d", err);
+		evt_log_put(EVT_ALARM_FAILED, err, (int32_t)(uintptr_t)wdt_sup_heartbeat);
+		res_stats_fail(RES_STATS_ALARM);
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+int wdt_sup_init(void){
+
+	if (!device_is_ready(wdt)) {
+		LOG_ERR("Watchdog device not ready");
+		return -ENODEV;
+	}
+
+	struct wdt_timeout_cfg cfg = {
+		.window.min = 0,
+		.window.max = WDT_TIMEOUT_MSEC,
+		.callback = NULL,
+		.flags = WDT_FLAG_RESET_SOC,
+	};
+
+	channel = wdt_install_timeout(wdt, &cfg);
+	if (channel < 0) {
+		LOG_ERR("Cannot install watchdog timeout: %d", channel);
+		return channel;
+	}
+
+	// keep counting while the CPU sleeps so that a wait that never ends is caught as well,
+	// only a debugger halt pauses it. Once started, the nRF52 watchdog runs until the next
+	// watchdog or power-on reset, so this is called early in every boot.
+	int err = wdt_setup(wdt, WDT_OPT_PAUSE_HALTED_BY_DBG);
+	if (err) {
+		LOG_ERR("Cannot start watchdog: %d", err);
+		channel = -1;
+		return err;
+	}
+
+	uint32_t now = k_uptime_get_32();
+	for (int i = 0; i < WDT_SUP_TASK_COUNT; i++) last_checkin[i] = now;
+	armed = BIT(WDT_SUP_ZIGBEE);
+
+	wdt_feed(wdt, channel);
+	LOG_INF("Watchdog started, timeout %d s", CONFIG_ZICADA_WATCHDOG_TIMEOUT_SEC);
+	return 0;
+}
+
+void wdt_sup_start(void){
+
+	ZB_SCHEDULE_APP_CALLBACK(wdt_sup_heartbeat, 0);
+}
+
+void wdt_sup_arm(enum wdt_sup_task task){
+
+	unsigned int key = irq_lock();
+
+	// the deadline starts when the work is handed to the task
+	if (!(armed & BIT(task))) {
+		armed |= BIT(task);
+		last_checkin[task] = k_uptime_get_32();
+	}
+
+	irq_unlock(key);
+}
+
+void wdt_sup_disarm(enum wdt_sup_task task){
+
+	unsigned int key = irq_lock();
+
+	armed &= ~BIT(task);
+	late &= ~BIT(task);
+
+	irq_unlock(key);
+}
+
+void wdt_sup_checkin(enum wdt_sup_task task){
+
+	if (channel < 0) return;
+
+	uint32_t now = k_uptime_get_32();
+	int late_task = -1;
+	uint32_t late_by = 0;
+
+	unsigned int key = irq_lock();
+
+	// check-ins run in the Zigbee thread, so each one also shows that it is alive
+	last_checkin[task] = now;
+	last_checkin[WDT_SUP_ZIGBEE] = now;
+	late &= ~BIT(task);
+
+	for (int i = 0; i < WDT_SUP_TASK_COUNT; i++) {
+		uint32_t age = now - last_checkin[i];
+		if ((armed & BIT(i)) && (age > deadline[i])) {
+			late_task = i;
+			late_by = age - deadline[i];
+			break;
+		}
+	}
+
+	// log each late task once, until it checks in again the watchdog is left to expire
+	bool first = (late_task >= 0) && !(late & BIT(late_task));
+	if (late_task >= 0) late |= BIT(late_task);
+
+	irq_unlock(key);
+
+	schedule_heartbeat();
+
+	if (late_task >= 0) {
+		if (first) {
+			LOG_ERR("Watchdog task %d late by %u ms, not feeding", late_task, (unsigned int)late_by);
+			evt_log_put(EVT_WDT_LATE, late_task, late_by);
+		}
+		return;
+	}
+
+	wdt_feed(wdt, channel);
+}
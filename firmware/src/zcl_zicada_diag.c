@@ -0,0 +1,27 @@
+// Zicada diagnostics cluster, see zcl_zicada_diag.h
+
+#include <zboss_api.h>
+
+#include "zcl_zicada_diag.h"
+
+//---------------------------------------------------------------------------------------------
+// cluster init: only the generic read attributes handling is needed
+//
+
+void zb_zcl_zicada_diag_init_server(void){
+
+	zb_zcl_add_cluster_handlers(ZB_ZCL_CLUSTER_ID_ZICADA_DIAG,
+		ZB_ZCL_CLUSTER_SERVER_ROLE,
+		(zb_zcl_cluster_check_value_t)NULL,
+		(zb_zcl_cluster_write_attr_hook_t)NULL,
+		(zb_zcl_cluster_handler_t)NULL);
+}
+
+void zb_zcl_zicada_diag_init_client(void){
+
+	zb_zcl_add_cluster_handlers(ZB_ZCL_CLUSTER_ID_ZICADA_DIAG,
+		ZB_ZCL_CLUSTER_CLIENT_ROLE,
+		(zb_zcl_cluster_check_value_t)NULL,
+		(zb_zcl_cluster_write_attr_hook_t)NULL,
+		(zb_zcl_cluster_handler_t)NULL);
+}
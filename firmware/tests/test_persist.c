@@ -0,0 +1,417 @@
+// Host test of the persisted state across resets and power loss (src/persist_store.c)
+//
+// Runs the firmware's schedule (src/app_sched.c) over a few days on an emulated device: the
+// retained snapshot, an NVRAM dataset that a write replaces as a whole, and the store of
+// persist.c on top of them. At every wake-up, between the change and the flush and again
+// after it, a copy of the device is reset in each way it can be:
+//   power loss          retained RAM is random, the NVRAM dataset has to be restored
+//   warm reset          the snapshot is resumed, and written again only with new changes
+//   torn warm reset     a bit of the snapshot is off (reset during an update), started cold
+//   random warm reset   random retained RAM with a warm reset cause, started cold
+// A power loss has to restore the dataset the store believes written, within
+// CONFIG_ZICADA_PERSIST_MIN_CHANGE of the state at the latest check, and that check may not
+// be older than a save period plus the longest gap between flushing wake-ups. Scenarios
+// cover degraded mode, failing samples and failing writes. NVRAM datasets of the wrong size
+// or version are checked to be refused.
+//
+// usage: test_persist
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "zicada_params.h"
+#include "app_sched.h"
+#include "persist_store.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define DAY_MSEC					(1000LL * 60 * 60 * 24)
+#define SAVE_PERIOD_MSEC			((int64_t)CONFIG_ZICADA_PERSIST_SAVE_CYCLES * TEMP_HUMIDITY_CHECK_PERIOD_MSEC)
+
+//---------------------------------------------------------------------------------------------
+// emulated device
+//
+
+struct scenario {
+	const char *name;
+	bool sensor_missing;		// degraded mode
+	int64_t sample_fail_from;	// ms, samples fail in [from, to)
+	int64_t sample_fail_to;
+	int64_t write_fail_from;	// ms, NVRAM writes fail in [from, to)
+	int64_t write_fail_to;
+	int64_t max_stale;			// ms, longest time between policy checks
+};
+
+struct device {
+	const struct scenario *sc;
+	struct app_state app;
+	struct persist_snapshot ram;	// retained RAM
+	struct persist_data nvram;		// NVRAM dataset, replaced as a whole by a write
+	uint16_t nvram_length;			// 0: never written
+	bool write_fails;
+	struct persist_store store;
+	struct persist_data checked;	// live state at the latest check that ended clean
+	int64_t checked_at;
+	uint32_t resets;
+	int failed;
+};
+
+// device whose store writes, the write callback has no context like the NVRAM one
+static struct device *writing;
+
+static int nvram_write(void){
+
+	if (writing->write_fails) return -1;
+	writing->nvram = writing->ram.data;
+	writing->nvram_length = sizeof(writing->nvram);
+	return 0;
+}
+
+// deterministic generator for the random RAM after a power loss
+static uint32_t rng_state = 0x5A1CADA;
+
+static uint32_t rng(void){
+
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+static void ram_randomize(struct persist_snapshot *ram){
+
+	uint8_t *p = (uint8_t *)ram;
+	for (size_t i = 0; i < sizeof(*ram); i++) p[i] = (uint8_t)rng();
+}
+
+// indoor values as the filter would deliver them: a daily triangle and a slow drift
+static int16_t triangle(int64_t now, int32_t amplitude){
+
+	int64_t phase = now % DAY_MSEC;
+	int64_t half = DAY_MSEC / 2;
+	int64_t up = (phase < half) ? phase : DAY_MSEC - phase;
+	return (int16_t)(amplitude * up / half);
+}
+
+// true if b holds a change of a that is worth a write
+static bool far_apart(const struct persist_data *a, const struct persist_data *b){
+
+	return (a->flags != b->flags) || (a->battery_percent != b->battery_percent) ||
+		(abs(a->temperature - b->temperature) >= CONFIG_ZICADA_PERSIST_MIN_CHANGE) ||
+		(abs(a->humidity - b->humidity) >= CONFIG_ZICADA_PERSIST_MIN_CHANGE);
+}
+
+static void fail(struct device *d, int64_t now, const char *what){
+
+	printf("FAIL %s at %.2f h: %s\n", d->sc->name, now / 3600000.0, what);
+	d->failed++;
+}
+
+static void device_copy(struct device *dst, const struct device *src){
+
+	*dst = *src;
+	dst->store.snapshot = &dst->ram;
+}
+
+// persist_init() and the NVRAM load of the stack startup
+static enum persist_start device_boot(struct device *d, bool warm, enum persist_load *load){
+
+	enum persist_start start = persist_store_start(&d->store, warm);
+	*load = d->nvram_length ? persist_store_load(&d->store, &d->nvram, d->nvram_length) : PERSIST_LOAD_OK;
+	return start;
+}
+
+// persist_flush(), a check that ended clean is remembered
+static void flush(struct device *d, int64_t now){
+
+	struct persist_stats before = d->store.stats;
+
+	writing = d;
+	d->write_fails = (now >= d->sc->write_fail_from) && (now < d->sc->write_fail_to);
+	persist_store_flush(&d->store, now);
+	if ((d->store.stats.writes != before.writes) || (d->store.stats.skipped != before.skipped)) {
+		d->checked = d->ram.data;
+		d->checked_at = now;
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// resets of a copy of the device at this point
+//
+
+static void power_loss(struct device *d, int64_t now){
+
+	struct device c;
+	enum persist_load load;
+
+	device_copy(&c, d);
+	ram_randomize(&c.ram);
+	if (device_boot(&c, false, &load) != PERSIST_START_COLD) fail(d, now, "power loss not started cold");
+	if (!d->nvram_length) {
+		if (c.store.restored) fail(d, now, "restored without an NVRAM dataset");
+		return;
+	}
+	if ((load != PERSIST_LOAD_OK) || !c.store.restored) {
+		fail(d, now, "NVRAM dataset not restored");
+		return;
+	}
+
+	// NVRAM writes replace the dataset as a whole, the store has to know which one it is,
+	// otherwise it would skip writes that are needed
+	if (memcmp(&c.ram.data, &d->nvram, sizeof(d->nvram)) || memcmp(&c.ram.written, &d->nvram, sizeof(d->nvram)) ||
+	    memcmp(&c.store.policy.written, &d->nvram, sizeof(d->nvram)) ||
+	    memcmp(&d->ram.written, &d->nvram, sizeof(d->nvram))) {
+		fail(d, now, "restored dataset differs from the one the store assumes written");
+	}
+
+	// everything seen at the latest clean check is in NVRAM or too close to matter
+	if ((d->checked_at > 0) && far_apart(&d->checked, &c.ram.data)) {
+		fail(d, now, "restored dataset further off the latest check than the minimum change");
+	}
+}
+
+static void warm_reset(struct device *d, int64_t now){
+
+	struct device c;
+	enum persist_load load;
+
+	device_copy(&c, d);
+	enum persist_start start = device_boot(&c, true, &load);
+	bool configured = (d->ram.data.flags & PERSIST_FLAG_REPORTING_CONFIGURED) != 0;
+
+	if (configured) {
+		if ((start != PERSIST_START_WARM) || !c.store.warm_restored || (d->nvram_length && (load != PERSIST_LOAD_IGNORED))) {
+			fail(d, now, "warm reset not resumed from the snapshot");
+			return;
+		}
+		if (memcmp(&c.ram.data, &d->ram.data, sizeof(d->ram.data))) fail(d, now, "warm reset lost live state");
+	} else if (start != PERSIST_START_RETAINED) {
+		fail(d, now, "warm reset before reporting ran did not keep the retained-only state");
+	}
+	if (c.ram.warm.warm_restarts != d->ram.warm.warm_restarts + 1) fail(d, now, "warm restart not counted");
+
+	// a reset loop costs no flash write, a change the flash lacks is not lost either
+	struct persist_data flash = c.nvram;
+	if (!c.nvram_length) memset(&flash, 0, sizeof(flash));
+	flush(&c, SAVE_PERIOD_MSEC);
+	bool needed = configured && far_apart(&flash, &d->ram.data);
+	if (!needed && c.store.stats.writes) fail(d, now, "warm reset wrote an unchanged dataset");
+	if (needed && (!c.store.stats.writes || memcmp(&c.nvram, &d->ram.data, sizeof(c.nvram)))) {
+		fail(d, now, "warm reset did not write the changes the flash lacks");
+	}
+}
+
+static void corrupt_warm_reset(struct device *d, int64_t now, bool random){
+
+	struct device c;
+	enum persist_load load;
+
+	device_copy(&c, d);
+	if (random) {
+		ram_randomize(&c.ram);
+	} else {
+		// one bit off anywhere, as left by a reset in the middle of an update
+		uint32_t bit = d->resets % (sizeof(c.ram) * 8);
+		((uint8_t *)&c.ram)[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+	}
+
+	if (device_boot(&c, true, &load) != PERSIST_START_CORRUPT) {
+		fail(d, now, random ? "random snapshot resumed" : "torn snapshot resumed");
+		return;
+	}
+	if (c.ram.warm.warm_restarts || c.ram.warm.wdt_resets) fail(d, now, "corrupt retained-only state kept");
+	if (c.store.restored != (d->nvram_length != 0)) fail(d, now, "NVRAM dataset not restored after a corrupt snapshot");
+	if (c.store.restored && memcmp(&c.ram.data, &d->nvram, sizeof(d->nvram))) {
+		fail(d, now, "restored dataset differs from NVRAM after a corrupt snapshot");
+	}
+}
+
+static void resets(struct device *d, int64_t now){
+
+	d->resets++;
+	power_loss(d, now);
+	warm_reset(d, now);
+	corrupt_warm_reset(d, now, false);
+	corrupt_warm_reset(d, now, true);
+
+	// and the check that would have been restored is recent
+	if ((d->store.policy.dirty & PERSIST_DIRTY_VALUES) && (now - d->checked_at > SAVE_PERIOD_MSEC + d->sc->max_stale)) {
+		fail(d, now, "changed values not looked at for longer than a save period");
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// the wake-ups of main.c
+//
+
+static void check_temp_humidity(struct device *d, int64_t now, uint32_t jobs){
+
+	if (!(jobs & APP_JOB_SAMPLE)) return;
+	// a failed sample returns early
+	if ((now >= d->sc->sample_fail_from) && (now < d->sc->sample_fail_to)) return;
+
+	struct persist_data *data = &d->ram.data;
+	data->temperature = 1900 + triangle(now, 400) + (int16_t)(now / DAY_MSEC * 50);
+	data->humidity = 4000 + triangle(now + DAY_MSEC / 3, 1500);
+	if (data->battery_phase < UINT8_MAX) data->battery_phase++;
+	persist_store_mark(&d->store, PERSIST_DIRTY_VALUES);
+
+	resets(d, now);
+	if (jobs & APP_JOB_PERSIST) flush(d, now);
+	resets(d, now);
+}
+
+static void check_battery_level(struct device *d, int64_t now, uint32_t jobs){
+
+	if (jobs & APP_JOB_BATTERY) {
+		// a fast draining cell, so that every check changes the battery value
+		struct persist_data *data = &d->ram.data;
+		if (data->battery_percent > 0) data->battery_percent--;
+		data->battery_phase = 0;
+		persist_store_mark(&d->store, PERSIST_DIRTY_VALUES);
+	}
+
+	resets(d, now);
+	if (jobs & APP_JOB_PERSIST) flush(d, now);
+	resets(d, now);
+}
+
+static int run(const struct scenario *sc, uint32_t days){
+
+	struct device d;
+	enum persist_load load;
+	int64_t next[APP_WAKE_COUNT];
+
+	memset(&d, 0, sizeof(d));
+	d.sc = sc;
+	d.app.joined = true;
+	d.app.sensor_ok = !sc->sensor_missing;
+	d.store.snapshot = &d.ram;
+	d.store.write = nvram_write;
+
+	// power-on with a blank NVRAM
+	ram_randomize(&d.ram);
+	device_boot(&d, false, &load);
+	d.ram.data.battery_percent = 200;
+
+	// configure_attribute_reporting() at the join, lost if the power goes before a flush
+	d.ram.data.flags |= PERSIST_FLAG_REPORTING_CONFIGURED;
+	persist_store_mark(&d.store, PERSIST_DIRTY_CONFIG);
+	resets(&d, 0);
+
+	for (int w = 0; w < APP_WAKE_COUNT; w++) {
+		uint32_t first = app_sched_first(w, &d.app);
+		next[w] = first ? first : INT64_MAX;
+	}
+
+	bool config_written = false;
+	for (;;) {
+		int w = (next[APP_WAKE_SENSOR] <= next[APP_WAKE_BATTERY]) ? APP_WAKE_SENSOR : APP_WAKE_BATTERY;
+		int64_t now = next[w];
+		if (now >= days * DAY_MSEC) break;
+
+		d.app.battery_phase = d.ram.data.battery_phase;
+		uint32_t jobs = app_sched_jobs(w, &d.app);
+		if (w == APP_WAKE_SENSOR) check_temp_humidity(&d, now, jobs);
+		else check_battery_level(&d, now, jobs);
+
+		// the reporting state is written by the first flushing wake-up after the join
+		if (!config_written && (jobs & APP_JOB_PERSIST) && (now < sc->write_fail_from)) {
+			if (!d.nvram_length || !(d.nvram.flags & PERSIST_FLAG_REPORTING_CONFIGURED)) {
+				fail(&d, now, "reporting state not written by the first flush");
+			}
+			config_written = true;
+		}
+
+		uint32_t delay = app_sched_next(w, &d.app);
+		next[w] = delay ? now + delay : INT64_MAX;
+	}
+
+	printf("%-16s %5u x 4 resets  %4u NVRAM writes  %s\n", sc->name, d.resets, d.store.stats.writes,
+		d.failed ? "failed" : "ok");
+	return d.failed;
+}
+
+//---------------------------------------------------------------------------------------------
+// NVRAM datasets the store has to refuse
+//
+
+static int check_datasets(void){
+
+	static const struct scenario sc = { .name = "datasets" };
+	struct device d, c;
+	enum persist_load load;
+	int failed = 0;
+
+	memset(&d, 0, sizeof(d));
+	d.sc = &sc;
+	d.store.snapshot = &d.ram;
+	d.nvram.version = PERSIST_VERSION;
+	d.nvram.flags = PERSIST_FLAG_REPORTING_CONFIGURED;
+	d.nvram.temperature = 2150;
+	d.nvram_length = sizeof(d.nvram);
+
+	device_copy(&c, &d);
+	c.nvram_length = sizeof(c.nvram) - 4;
+	device_boot(&c, false, &load);
+	if ((load != PERSIST_LOAD_SIZE) || c.store.restored || (c.ram.data.temperature != 0)) {
+		printf("FAIL %s: dataset of the wrong size taken\n", sc.name);
+		failed++;
+	}
+
+	device_copy(&c, &d);
+	c.nvram.version = PERSIST_VERSION + 1;
+	device_boot(&c, false, &load);
+	if ((load != PERSIST_LOAD_VERSION) || c.store.restored || (c.ram.data.temperature != 0)) {
+		printf("FAIL %s: dataset of an unknown version taken\n", sc.name);
+		failed++;
+	}
+
+	device_copy(&c, &d);
+	device_boot(&c, false, &load);
+	if ((load != PERSIST_LOAD_OK) || !c.store.restored || memcmp(&c.ram.data, &d.nvram, sizeof(d.nvram))) {
+		printf("FAIL %s: valid dataset not taken\n", sc.name);
+		failed++;
+	}
+
+	printf("%-16s %s\n", sc.name, failed ? "failed" : "ok");
+	return failed;
+}
+
+//---------------------------------------------------------------------------------------------
+// main
+//
+
+int main(void){
+
+	static const struct scenario scenarios[] = {
+		{ .name = "normal", .max_stale = TEMP_HUMIDITY_CHECK_PERIOD_MSEC },
+		// only the battery check is left to flush
+		{ .name = "degraded", .sensor_missing = true, .max_stale = BATTERY_CHECK_PERIOD_MSEC },
+		{ .name = "sample failures", .sample_fail_from = DAY_MSEC, .sample_fail_to = 2 * DAY_MSEC,
+			.max_stale = BATTERY_CHECK_PERIOD_MSEC },
+		// a failed write is tried again one save period later
+		{ .name = "write failures", .write_fail_from = DAY_MSEC, .write_fail_to = DAY_MSEC + 6 * 3600000LL,
+			.max_stale = 6 * 3600000LL + SAVE_PERIOD_MSEC + TEMP_HUMIDITY_CHECK_PERIOD_MSEC },
+	};
+	int failed = check_datasets();
+
+	for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+		struct scenario sc = scenarios[i];
+		if (sc.sample_fail_to == 0) sc.sample_fail_from = sc.sample_fail_to = INT64_MAX;
+		if (sc.write_fail_to == 0) sc.write_fail_from = sc.write_fail_to = INT64_MAX;
+		failed += run(&sc, 3);
+	}
+
+	if (failed) {
+		printf("%d check(s) failed\n", failed);
+		return 1;
+	}
+	printf("all resets restore a consistent state\n");
+	return 0;
+}
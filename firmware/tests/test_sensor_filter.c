@@ -0,0 +1,235 @@
+// Host test of the sensor filter (src/sensor_filter.c) over recorded noisy traces
+//
+// Every measurement of a trace goes through the median, the gate and the EMA as in
+// check_temp_humidity() and, for comparison, through the raw path the firmware had before the
+// filter (the first sample of the burst straight into the attribute). Both are reported with
+// the ZBOSS rules (tools/sim_common/report_model.c). The trace header holds the expectations:
+//   # preset NAME           reporting preset of the converter (default: its default preset)
+//   # expect rejected N     measurements dropped by the gate
+//   # expect reports N      reports with the filter
+//   # expect suppressed N   reports the filter saves against the raw path
+//   # expect tolerance N    largest distance of an accepted value from the clean samples
+// A measurement made only of glitches has to be rejected, whatever the header says.
+//
+// usage: test_sensor_filter TRACE...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "zicada_params.h"
+#include "sensor_filter.h"
+#include "report_model.h"
+
+//---------------------------------------------------------------------------------------------
+// traces
+//
+
+struct sample {
+	uint32_t t;				// seconds
+	uint8_t channel;		// REPORT_TEMP or REPORT_HUMIDITY
+	int32_t value;
+	bool glitch;
+};
+
+struct trace {
+	struct sample *samples;
+	size_t count, cap;
+	char preset[32];
+	long expect_rejected, expect_reports, expect_suppressed, expect_tolerance;
+};
+
+static void trace_add(struct trace *tr, const struct sample *s){
+
+	if (tr->count == tr->cap) {
+		tr->cap = tr->cap ? tr->cap * 2 : 1024;
+		tr->samples = realloc(tr->samples, tr->cap * sizeof(*tr->samples));
+		if (!tr->samples) exit(2);
+	}
+	tr->samples[tr->count++] = *s;
+}
+
+static int load_trace(struct trace *tr, const char *path){
+
+	FILE *f = fopen(path, "r");
+	if (!f) return -1;
+
+	char line[128], kind[16], flag[16];
+	unsigned long t;
+	long value;
+
+	strcpy(tr->preset, report_default_preset);
+	tr->expect_rejected = tr->expect_reports = tr->expect_suppressed = tr->expect_tolerance = -1;
+	while (fgets(line, sizeof(line), f)) {
+		if (line[0] == '#') {
+			sscanf(line, "# preset %31s", tr->preset);
+			sscanf(line, "# expect rejected %ld", &tr->expect_rejected);
+			sscanf(line, "# expect reports %ld", &tr->expect_reports);
+			sscanf(line, "# expect suppressed %ld", &tr->expect_suppressed);
+			sscanf(line, "# expect tolerance %ld", &tr->expect_tolerance);
+			continue;
+		}
+		flag[0] = 0;
+		if (sscanf(line, "%lu,%15[^,],%ld,%15s", &t, kind, &value, flag) < 3) continue;
+
+		struct sample s = { (uint32_t)t, REPORT_TEMP, (int32_t)value, !strcmp(flag, "glitch") };
+		if (!strcmp(kind, "humidity")) s.channel = REPORT_HUMIDITY;
+		else if (strcmp(kind, "temp")) continue;
+		trace_add(tr, &s);
+	}
+	fclose(f);
+	return 0;
+}
+
+//---------------------------------------------------------------------------------------------
+// replay
+//
+
+struct result {
+	uint32_t rejected;
+	uint32_t reports;
+	uint32_t raw_reports;
+	int32_t max_error;
+	uint32_t glitches_passed;	// measurements of glitches only that were accepted
+};
+
+struct channel {
+	struct sensor_filter filter;
+	struct report_attr filtered;
+	struct report_attr raw;
+};
+
+static void replay(const struct trace *tr, const struct report_cfg *cfg, struct result *res){
+
+	static const struct sensor_filter_cfg filter_cfg[] = {
+		[REPORT_TEMP] = { HDC2080_TEMPERATURE_MIN, HDC2080_TEMPERATURE_MAX,
+			CONFIG_ZICADA_FILTER_TEMP_MAX_STEP, CONFIG_ZICADA_FILTER_MAX_REJECTS,
+			CONFIG_ZICADA_FILTER_EMA_SHIFT },
+		[REPORT_HUMIDITY] = { HDC2080_HUMIDITY_MIN, HDC2080_HUMIDITY_MAX,
+			CONFIG_ZICADA_FILTER_HUMIDITY_MAX_STEP, CONFIG_ZICADA_FILTER_MAX_REJECTS,
+			CONFIG_ZICADA_FILTER_EMA_SHIFT },
+	};
+	struct channel ch[REPORT_HUMIDITY + 1];
+
+	memset(ch, 0, sizeof(ch));
+	memset(res, 0, sizeof(*res));
+	for (int c = REPORT_TEMP; c <= REPORT_HUMIDITY; c++) {
+		sensor_filter_init(&ch[c].filter, &filter_cfg[c]);
+		ch[c].filtered.cfg = &cfg[c];
+		ch[c].raw.cfg = &cfg[c];
+	}
+
+	// consecutive samples of the same time and channel are one burst
+	for (size_t i = 0; i < tr->count;) {
+		const struct sample *first = &tr->samples[i];
+		int32_t burst[SENSOR_FILTER_MAX_BURST], clean[SENSOR_FILTER_MAX_BURST];
+		uint8_t n = 0, n_clean = 0;
+
+		while ((i < tr->count) && (tr->samples[i].t == first->t) &&
+		       (tr->samples[i].channel == first->channel)) {
+			const struct sample *s = &tr->samples[i++];
+			if (n == SENSOR_FILTER_MAX_BURST) continue;
+			burst[n++] = s->value;
+			if (!s->glitch) clean[n_clean++] = s->value;
+		}
+
+		struct channel *c = &ch[first->channel];
+		uint64_t now_ms = first->t * 1000ULL;
+		int32_t out;
+
+		c->raw.value = burst[0];
+		c->raw.valid = true;
+
+		if (sensor_filter_update(&c->filter, sensor_filter_median(burst, n), &out)) {
+			c->filtered.value = out;
+			c->filtered.valid = true;
+			if (n_clean == 0) {
+				res->glitches_passed++;
+			} else {
+				int32_t error = abs(out - sensor_filter_median(clean, n_clean));
+				if (error > res->max_error) res->max_error = error;
+			}
+		}
+
+		if (report_check(&c->filtered, now_ms) != REPORT_NONE) res->reports++;
+		if (report_check(&c->raw, now_ms) != REPORT_NONE) res->raw_reports++;
+	}
+	res->rejected = ch[REPORT_TEMP].filter.rejected + ch[REPORT_HUMIDITY].filter.rejected;
+}
+
+//---------------------------------------------------------------------------------------------
+// checks
+//
+
+static int expect(const char *name, const char *what, long value, long expected, bool exact){
+
+	if (expected < 0) {
+		printf("FAIL %s: no expectation for %s (got %ld)\n", name, what, value);
+		return 1;
+	}
+	if (exact ? (value != expected) : (value > expected)) {
+		printf("FAIL %s %s: %ld, expected %s%ld\n", name, what, value, exact ? "" : "at most ", expected);
+		return 1;
+	}
+	return 0;
+}
+
+static int run_trace(const char *path){
+
+	struct trace tr = { 0 };
+	struct result res;
+
+	if (load_trace(&tr, path)) {
+		printf("FAIL %s: cannot open\n", path);
+		return 1;
+	}
+
+	const struct report_cfg *cfg = report_preset_find(tr.preset);
+	if (!cfg) {
+		printf("FAIL %s: unknown preset %s\n", path, tr.preset);
+		free(tr.samples);
+		return 1;
+	}
+
+	replay(&tr, cfg, &res);
+	free(tr.samples);
+
+	long suppressed = (long)res.raw_reports - (long)res.reports;
+	printf("%-28s %4u rejected  %4u reports  %4ld suppressed (raw %u)  max error %d\n", path,
+		res.rejected, res.reports, suppressed, res.raw_reports, (int)res.max_error);
+
+	int failed = 0;
+	if (res.glitches_passed) {
+		printf("FAIL %s: %u measurements of glitches only were accepted\n", path, res.glitches_passed);
+		failed++;
+	}
+	failed += expect(path, "rejected", res.rejected, tr.expect_rejected, true);
+	failed += expect(path, "reports", res.reports, tr.expect_reports, true);
+	failed += expect(path, "suppressed", suppressed, tr.expect_suppressed, true);
+	failed += expect(path, "max error", res.max_error, tr.expect_tolerance, false);
+	return failed;
+}
+
+//---------------------------------------------------------------------------------------------
+// main
+//
+
+int main(int argc, char **argv){
+
+	int failed = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s TRACE...\n", argv[0]);
+		return 2;
+	}
+	for (int i = 1; i < argc; i++) failed += run_trace(argv[i]);
+
+	if (failed) {
+		printf("%d check(s) failed\n", failed);
+		return 1;
+	}
+	printf("all traces as expected\n");
+	return 0;
+}
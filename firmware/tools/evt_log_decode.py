@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Decode the Zicada binary event log.
+
+The firmware prints its retained event ring over RTT as
+
+    EVL <head> <boots> <count>
+    EVR <24 hex digits>
+    ...
+
+This script reads such a capture (file or stdin), looks up the event ids in the
+EVT_LOG_EVENTS table of include/evt_log.h and prints one line of text per record.
+Once a boot has a time sync record (EVT_TIME_SYNC), all records of that boot also get the
+UTC time, projected from the nearest sync with the drift it measured.
+
+Usage: evt_log_decode.py [capture.txt] [--header path/to/evt_log.h]
+"""
+
+import argparse
+import datetime
+import os
+import re
+import struct
+import sys
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(__file__), "..", "include", "evt_log.h")
+
+# struct evt_log_rec: uint32 timestamp, uint16 id, int16 arg0, int32 arg1 (little endian)
+RECORD = struct.Struct("<IHhi")
+
+# ZCL time is in seconds since 2000-01-01 00:00 UTC
+ZCL_EPOCH = datetime.datetime(2000, 1, 1, tzinfo=datetime.timezone.utc)
+
+EVENT_RE = re.compile(r'^\s*X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+
+
+def load_events(header):
+    events = []
+    with open(header, encoding="utf-8") as f:
+        for line in f:
+            m = EVENT_RE.match(line)
+            if m:
+                events.append((m.group(1), m.group(2)))
+    if not events:
+        sys.exit(f"no EVT_LOG_EVENTS entries found in {header}")
+    return events
+
+
+def fields(arg0, arg1):
+    return {
+        "a0": arg0,
+        "a1": arg1,
+        "a0_c": f"{arg0 / 100:.2f}",
+        "a1_c": f"{arg1 / 100:.2f}",
+        "a0_x": f"0x{arg0 & 0xFFFF:04x}",
+        "a1_x": f"0x{arg1 & 0xFFFFFFFF:08x}",
+    }
+
+
+def utc_text(timestamp, syncs):
+    """wall-clock time of a record from the nearest sync of its boot, or blanks"""
+    if not syncs:
+        return " " * 23
+    sync_ts, utc_sec, drift_ppm = min(syncs, key=lambda s: abs(s[0] - timestamp))
+    seconds = utc_sec + 0.5 + (timestamp - sync_ts) / 1000 * (1 + drift_ppm / 1e6)
+    return (ZCL_EPOCH + datetime.timedelta(seconds=seconds)).strftime("%Y-%m-%d %H:%M:%S.%f")[:23]
+
+
+def print_boot(records):
+    syncs = [(ts, a1, a0) for ts, name, _, a0, a1 in records if name == "EVT_TIME_SYNC"]
+    for timestamp, name, text, _, _ in records:
+        if name == "EVT_BOOT":
+            print("---")
+        print(f"{timestamp / 1000:12.3f}  {utc_text(timestamp, syncs)}  {name:<24} {text}")
+
+
+def decode(lines, events):
+    # records are collected per boot, the time syncs of a boot map all its records to UTC
+    boot = []
+    for line in lines:
+        line = line.strip()
+        # RTT viewers may prefix lines with a timestamp or channel, search anywhere
+        m = re.search(r"EVL (\d+) (\d+) (\d+)", line)
+        if m:
+            print_boot(boot)
+            boot = []
+            head, boots, count = (int(x) for x in m.groups())
+            print(f"--- event log: {count} records, {head} written, boot #{boots} ---")
+            continue
+        m = re.search(r"EVR ([0-9a-fA-F]{%d})" % (RECORD.size * 2), line)
+        if not m:
+            continue
+        timestamp, evt_id, arg0, arg1 = RECORD.unpack(bytes.fromhex(m.group(1)))
+        if evt_id < len(events):
+            name, fmt = events[evt_id]
+            text = fmt.format(**fields(arg0, arg1))
+        else:
+            name, text = f"EVT_{evt_id}", f"unknown event, args {arg0} {arg1}"
+        if name == "EVT_BOOT":
+            print_boot(boot)
+            boot = []
+        boot.append((timestamp, name, text, arg0, arg1))
+    print_boot(boot)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="RTT capture, default stdin")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="path to evt_log.h")
+    args = parser.parse_args()
+
+    events = load_events(args.header)
+    if args.capture:
+        with open(args.capture, encoding="utf-8", errors="replace") as f:
+            decode(f, events)
+    else:
+        decode(sys.stdin, events)
+
+
+if __name__ == "__main__":
+    main()
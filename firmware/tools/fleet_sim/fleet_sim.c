@@ -0,0 +1,578 @@
+// Host fleet traffic generator: load tests for coordinators and Zigbee2MQTT
+//
+// Emulates N Zicadas with the firmware's schedule (zicada_params.h), filter
+// (src/sensor_filter.c) and the ZBOSS reporting rules (sim_common/report_model.c) and writes
+// the resulting frame stream: attribute reports for temperature, humidity, battery and
+// contact and the On/Off commands of the contact. Each device sits in its own room of the
+// shared climate model (sim_common/climate.c). The reporting configuration is one of the
+// presets zicada_converter.js writes to the device, generated from the converter at build
+// time, --reporting firmware keeps the firmware defaults of a device that was never
+// configured. Frames are complete unsecured 802.15.4 / NWK / APS / ZCL frames (network
+// security is left out so that captures decode without the network key).
+//
+// usage: fleet_sim [options]
+//   --devices N          number of emulated devices (default 100)
+//   --days N             simulated time (default 1)
+//   --doors-per-day N    contact changes per device and day (default 24)
+//   --reporting NAME     low_airtime, balanced, responsive or firmware (default: the
+//                        converter's default preset)
+//   --pcap FILE          write the frames to a pcap file (802.15.4 with FCS)
+//   --udp HOST:PORT      send each frame as a datagram to a stand-in coordinator
+//                        (see fleet_sink.py)
+//   --speed X            time compression for --udp: simulated seconds per second, 0 sends
+//                        as fast as possible (default 0)
+//   --seed N             random seed (default fixed, runs are reproducible)
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "zicada_params.h"
+#include "sensor_filter.h"
+#include "app_sched.h"
+#include "report_model.h"
+#include "climate.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+// ZCL ids used by the firmware (main.c) and the converter
+#define ZCL_CLUSTER_POWER_CONFIG		0x0001
+#define ZCL_CLUSTER_ON_OFF				0x0006
+#define ZCL_CLUSTER_BINARY_INPUT		0x000F
+#define ZCL_CLUSTER_TEMPERATURE			0x0402
+#define ZCL_CLUSTER_HUMIDITY			0x0405
+#define ZCL_ATTR_MEASURED_VALUE			0x0000
+#define ZCL_ATTR_BATTERY_PERCENTAGE		0x0021
+#define ZCL_ATTR_PRESENT_VALUE			0x0055
+#define ZCL_TYPE_BOOL					0x10
+#define ZCL_TYPE_U8						0x20
+#define ZCL_TYPE_U16					0x21
+#define ZCL_TYPE_S16					0x29
+#define ZCL_CMD_REPORT_ATTRIBUTES		0x0A
+#define ZCL_CMD_OFF						0x00
+#define ZCL_CMD_ON						0x01
+#define ZB_HA_PROFILE					0x0104
+
+#define PAN_ID							0x1A62
+#define COORDINATOR_ADDR				0x0000
+#define FIRST_DEVICE_ADDR				0x1000
+#define ENDPOINT						1
+
+// pcap link type LINKTYPE_IEEE802_15_4_WITHFCS
+#define PCAP_LINKTYPE_802154_FCS		195
+
+// datagram header for --udp, followed by the 802.15.4 frame
+#define FLEET_UDP_MAGIC					0x5A464C54UL	// "ZFLT"
+
+#define MAX_FRAME						127
+
+//---------------------------------------------------------------------------------------------
+// typedefs
+//
+
+struct device {
+	uint16_t addr;
+	uint8_t mac_seq, nwk_seq, aps_counter, zcl_tsn;
+	struct sensor_filter temp_filter, humidity_filter;
+	struct report_attr attrs[REPORT_ATTR_COUNT];
+	struct climate room;
+	bool contact;
+	uint64_t next_th, next_bat, next_contact, next_report;	// ms
+	uint64_t due;				// earliest of the above, heap key
+};
+
+struct fleet_stats {
+	uint64_t frames[REPORT_ATTR_COUNT + 1];	// reports per attribute, contact commands
+	uint64_t reasons[REPORT_REASON_COUNT];
+	uint64_t bytes;
+	uint32_t rejected;
+	uint32_t peak_per_sec;
+	uint64_t peak_at;
+};
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+// ZCL encoding of the reported attributes
+static const struct { uint16_t cluster, attr; uint8_t type; } attr_ids[REPORT_ATTR_COUNT] = {
+	[REPORT_TEMP]		= { ZCL_CLUSTER_TEMPERATURE, ZCL_ATTR_MEASURED_VALUE, ZCL_TYPE_S16 },
+	[REPORT_HUMIDITY]	= { ZCL_CLUSTER_HUMIDITY, ZCL_ATTR_MEASURED_VALUE, ZCL_TYPE_U16 },
+	[REPORT_BATTERY]	= { ZCL_CLUSTER_POWER_CONFIG, ZCL_ATTR_BATTERY_PERCENTAGE, ZCL_TYPE_U8 },
+	[REPORT_CONTACT]	= { ZCL_CLUSTER_BINARY_INPUT, ZCL_ATTR_PRESENT_VALUE, ZCL_TYPE_BOOL },
+};
+
+static const struct sensor_filter_cfg temp_filter_cfg = {
+	HDC2080_TEMPERATURE_MIN, HDC2080_TEMPERATURE_MAX, CONFIG_ZICADA_FILTER_TEMP_MAX_STEP,
+	CONFIG_ZICADA_FILTER_MAX_REJECTS, CONFIG_ZICADA_FILTER_EMA_SHIFT };
+static const struct sensor_filter_cfg humidity_filter_cfg = {
+	HDC2080_HUMIDITY_MIN, HDC2080_HUMIDITY_MAX, CONFIG_ZICADA_FILTER_HUMIDITY_MAX_STEP,
+	CONFIG_ZICADA_FILTER_MAX_REJECTS, CONFIG_ZICADA_FILTER_EMA_SHIFT };
+
+// every device is joined with a working sensor, the firmware's schedule decides the wake-ups
+static const struct app_state joined_state = { .joined = true, .sensor_ok = true };
+
+static struct device *devices;
+static uint32_t device_count = 100;
+static uint32_t doors_per_day = 24;
+
+static FILE *pcap;
+static int udp_sock = -1;
+static struct sockaddr_storage udp_addr;
+static socklen_t udp_addr_len;
+static double speed;
+static struct timespec wall_start;
+
+static struct fleet_stats stats;
+static uint64_t sec_bucket = UINT64_MAX;
+static uint32_t sec_count;
+
+// deterministic generator so that runs are reproducible
+static uint32_t rng_state = 0x5A1CADA;
+
+static uint32_t rng(void){
+
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+static double rng_unit(void){
+
+	return (rng() & 0xFFFFFF) / (double)0x1000000;
+}
+
+//---------------------------------------------------------------------------------------------
+// frame encoding
+//
+
+static uint8_t *put16(uint8_t *p, uint16_t v){
+
+	p[0] = v & 0xFF;
+	p[1] = v >> 8;
+	return p + 2;
+}
+
+// 802.15.4 FCS: CRC-16/KERMIT
+static uint16_t fcs(const uint8_t *data, size_t len){
+
+	uint16_t crc = 0;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (int b = 0; b < 8; b++) crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+	}
+	return crc;
+}
+
+// MAC data frame to the coordinator with NWK and APS headers around a ZCL payload
+static size_t build_frame(struct device *d, uint8_t *buf, uint16_t cluster,
+                          const uint8_t *zcl, size_t zcl_len){
+
+	uint8_t *p = buf;
+
+	// MAC: data, ack request, PAN id compression, short addresses
+	*p++ = 0x61;
+	*p++ = 0x88;
+	*p++ = d->mac_seq++;
+	p = put16(p, PAN_ID);
+	p = put16(p, COORDINATOR_ADDR);
+	p = put16(p, d->addr);
+
+	// NWK: data, protocol version 2, route discovery enabled, no security
+	p = put16(p, 0x0048);
+	p = put16(p, COORDINATOR_ADDR);
+	p = put16(p, d->addr);
+	*p++ = 30;
+	*p++ = d->nwk_seq++;
+
+	// APS: unicast data with ack request
+	*p++ = 0x40;
+	*p++ = ENDPOINT;
+	p = put16(p, cluster);
+	p = put16(p, ZB_HA_PROFILE);
+	*p++ = ENDPOINT;
+	*p++ = d->aps_counter++;
+
+	memcpy(p, zcl, zcl_len);
+	p += zcl_len;
+
+	p = put16(p, fcs(buf, p - buf));
+	return p - buf;
+}
+
+//---------------------------------------------------------------------------------------------
+// output
+//
+
+static void pcap_open(const char *path){
+
+	pcap = fopen(path, "wb");
+	if (!pcap) {
+		fprintf(stderr, "cannot open %s\n", path);
+		exit(2);
+	}
+
+	uint32_t hdr[6] = { 0xA1B2C3D4, 0x00040002, 0, 0, 65535, PCAP_LINKTYPE_802154_FCS };
+	fwrite(hdr, sizeof(hdr), 1, pcap);
+}
+
+static void udp_open(const char *target){
+
+	char host[128];
+	const char *colon = strrchr(target, ':');
+	if (!colon || (colon - target >= (long)sizeof(host))) {
+		fprintf(stderr, "--udp expects HOST:PORT\n");
+		exit(2);
+	}
+	memcpy(host, target, colon - target);
+	host[colon - target] = 0;
+
+	struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM }, *res;
+	if (getaddrinfo(host, colon + 1, &hints, &res)) {
+		fprintf(stderr, "cannot resolve %s\n", target);
+		exit(2);
+	}
+	udp_sock = socket(res->ai_family, res->ai_socktype, 0);
+	memcpy(&udp_addr, res->ai_addr, res->ai_addrlen);
+	udp_addr_len = res->ai_addrlen;
+	freeaddrinfo(res);
+	if (udp_sock < 0) {
+		perror("socket");
+		exit(2);
+	}
+}
+
+static uint64_t wall_ns(void){
+
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// with time compression, wait until the simulated time is due on the wall clock
+static void pace(uint64_t now_ms){
+
+	if (speed <= 0) return;
+
+	double due = now_ms / 1000.0 / speed;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	double elapsed = (ts.tv_sec - wall_start.tv_sec) + (ts.tv_nsec - wall_start.tv_nsec) / 1e9;
+	if (due > elapsed) {
+		double wait = due - elapsed;
+		struct timespec req = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+		nanosleep(&req, NULL);
+	}
+}
+
+static void emit(struct device *d, uint64_t now_ms, uint16_t cluster, const uint8_t *zcl, size_t zcl_len){
+
+	uint8_t frame[MAX_FRAME + 32];
+	size_t len = build_frame(d, frame, cluster, zcl, zcl_len);
+
+	stats.bytes += len;
+	if (now_ms / 1000 != sec_bucket) {
+		sec_bucket = now_ms / 1000;
+		sec_count = 0;
+	}
+	if (++sec_count > stats.peak_per_sec) {
+		stats.peak_per_sec = sec_count;
+		stats.peak_at = sec_bucket;
+	}
+
+	if (pcap) {
+		uint32_t rec[4] = { (uint32_t)(now_ms / 1000), (uint32_t)(now_ms % 1000) * 1000, len, len };
+		fwrite(rec, sizeof(rec), 1, pcap);
+		fwrite(frame, len, 1, pcap);
+	}
+
+	if (udp_sock >= 0) {
+		uint8_t dgram[24 + sizeof(frame)];
+		uint32_t magic = FLEET_UDP_MAGIC, index = d - devices;
+
+		pace(now_ms);
+		uint64_t sent = wall_ns();
+		memcpy(dgram, &magic, 4);
+		memcpy(dgram + 4, &index, 4);
+		memcpy(dgram + 8, &now_ms, 8);
+		memcpy(dgram + 16, &sent, 8);
+		memcpy(dgram + 24, frame, len);
+		if (sendto(udp_sock, dgram, 24 + len, 0, (struct sockaddr *)&udp_addr, udp_addr_len) < 0) {
+			perror("sendto");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// device behavior
+//
+
+// Report Attributes, server to client, default response disabled (ZBOSS reporting)
+static void send_report(struct device *d, enum report_attr_id id, uint64_t now_ms){
+
+	uint8_t zcl[8], *p = zcl;
+	uint8_t type = attr_ids[id].type;
+	int32_t value = d->attrs[id].value;
+
+	*p++ = 0x18;
+	*p++ = d->zcl_tsn++;
+	*p++ = ZCL_CMD_REPORT_ATTRIBUTES;
+	p = put16(p, attr_ids[id].attr);
+	*p++ = type;
+	if ((type == ZCL_TYPE_U8) || (type == ZCL_TYPE_BOOL)) *p++ = (uint8_t)value;
+	else p = put16(p, (uint16_t)value);
+
+	emit(d, now_ms, attr_ids[id].cluster, zcl, p - zcl);
+}
+
+// On/Off command from the client role, like contact_send_on_off() in main.c
+static void send_on_off(struct device *d, uint8_t cmd, uint64_t now_ms){
+
+	uint8_t zcl[3] = { 0x11, d->zcl_tsn++, cmd };
+
+	emit(d, now_ms, ZCL_CLUSTER_ON_OFF, zcl, sizeof(zcl));
+	stats.frames[REPORT_ATTR_COUNT]++;
+}
+
+static void device_report(struct device *d, uint64_t now_ms){
+
+	d->next_report = UINT64_MAX;
+	for (int i = 0; i < REPORT_ATTR_COUNT; i++) {
+		enum report_reason reason = report_check(&d->attrs[i], now_ms);
+		if (reason != REPORT_NONE) {
+			send_report(d, i, now_ms);
+			stats.frames[i]++;
+			stats.reasons[reason]++;
+		}
+		uint64_t due = report_due(&d->attrs[i]);
+		if (due < d->next_report) d->next_report = due;
+	}
+}
+
+// the room's climate as the sensor reads it, with a few hundredths of noise
+static int32_t sensor_read(const struct device *d, uint64_t now_ms, bool humidity){
+
+	uint64_t t = now_ms / 1000;
+	int32_t value = humidity ? climate_humidity(&d->room, t) : climate_temperature(&d->room, t);
+	return value + (int32_t)((rng_unit() - 0.5) * 6);
+}
+
+static uint64_t next_contact_time(uint64_t now_ms){
+
+	if (doors_per_day == 0) return UINT64_MAX;
+
+	// exponential inter-arrival times, at least one second between two changes
+	double mean_ms = 86400000.0 / doors_per_day;
+	double u = rng_unit();
+	return now_ms + 1000 + (uint64_t)(-mean_ms * log(1.0 - u));
+}
+
+static void check_temp_humidity(struct device *d, uint64_t now_ms){
+
+	int32_t t_burst[SENSOR_FILTER_MAX_BURST], h_burst[SENSOR_FILTER_MAX_BURST], out;
+
+	for (int i = 0; i < CONFIG_ZICADA_FILTER_BURST; i++) {
+		t_burst[i] = sensor_read(d, now_ms, false);
+		h_burst[i] = sensor_read(d, now_ms, true);
+	}
+	if (sensor_filter_update(&d->temp_filter, sensor_filter_median(t_burst, CONFIG_ZICADA_FILTER_BURST), &out)) {
+		d->attrs[REPORT_TEMP].value = out;
+		d->attrs[REPORT_TEMP].valid = true;
+	}
+	if (sensor_filter_update(&d->humidity_filter, sensor_filter_median(h_burst, CONFIG_ZICADA_FILTER_BURST), &out)) {
+		d->attrs[REPORT_HUMIDITY].value = out;
+		d->attrs[REPORT_HUMIDITY].valid = true;
+	}
+	d->next_th = now_ms + app_sched_next(APP_WAKE_SENSOR, &joined_state);
+}
+
+static void check_battery(struct device *d, uint64_t now_ms){
+
+	// percentage remaining in half percent steps, one step down per check until empty
+	struct report_attr *a = &d->attrs[REPORT_BATTERY];
+	if (!a->valid) a->value = 200 - rng() % 40;
+	else if (a->value > 0) a->value--;
+	a->valid = true;
+	d->next_bat = now_ms + app_sched_next(APP_WAKE_BATTERY, &joined_state);
+}
+
+static void device_init(struct device *d, uint32_t index, const struct report_cfg *cfg){
+
+	memset(d, 0, sizeof(*d));
+	d->addr = FIRST_DEVICE_ADDR + index;
+	d->mac_seq = rng();
+	d->nwk_seq = rng();
+	d->aps_counter = rng();
+	d->zcl_tsn = rng();
+	climate_init(&d->room, rng());
+	sensor_filter_init(&d->temp_filter, &temp_filter_cfg);
+	sensor_filter_init(&d->humidity_filter, &humidity_filter_cfg);
+
+	for (int i = 0; i < REPORT_ATTR_COUNT; i++) d->attrs[i].cfg = &cfg[i];
+
+	// devices joined at random times within one check period
+	uint64_t joined = rng() % TEMP_HUMIDITY_CHECK_PERIOD_MSEC;
+	d->next_th = joined + app_sched_first(APP_WAKE_SENSOR, &joined_state);
+	d->next_bat = joined + app_sched_first(APP_WAKE_BATTERY, &joined_state);
+	d->next_contact = next_contact_time(joined);
+	d->next_report = UINT64_MAX;
+
+	// the contact state is known from the start (open)
+	d->attrs[REPORT_CONTACT].valid = true;
+}
+
+static void device_update_due(struct device *d){
+
+	d->due = d->next_th;
+	if (d->next_bat < d->due) d->due = d->next_bat;
+	if (d->next_contact < d->due) d->due = d->next_contact;
+	if (d->next_report < d->due) d->due = d->next_report;
+}
+
+static void device_step(struct device *d){
+
+	uint64_t now = d->due;
+
+	if (now >= d->next_contact) {
+		// hall interrupt: On when the magnet leaves (contact opened), Off when it returns
+		d->contact = !d->contact;
+		send_on_off(d, d->contact ? ZCL_CMD_OFF : ZCL_CMD_ON, now);
+		d->attrs[REPORT_CONTACT].value = d->contact;
+		d->next_contact = next_contact_time(now);
+	}
+	if (now >= d->next_th) check_temp_humidity(d, now);
+	if (now >= d->next_bat) check_battery(d, now);
+
+	// reports go out from the same wake-up as the measurement, or on the max interval
+	device_report(d, now);
+	device_update_due(d);
+}
+
+//---------------------------------------------------------------------------------------------
+// event queue: binary min-heap of devices by due time
+//
+
+static uint32_t *heap;
+
+static void heap_swap(uint32_t a, uint32_t b){
+
+	uint32_t t = heap[a];
+	heap[a] = heap[b];
+	heap[b] = t;
+}
+
+static void heap_down(uint32_t i, uint32_t n){
+
+	for (;;) {
+		uint32_t l = 2 * i + 1, r = l + 1, m = i;
+		if ((l < n) && (devices[heap[l]].due < devices[heap[m]].due)) m = l;
+		if ((r < n) && (devices[heap[r]].due < devices[heap[m]].due)) m = r;
+		if (m == i) return;
+		heap_swap(i, m);
+		i = m;
+	}
+}
+
+//---------------------------------------------------------------------------------------------
+// main
+//
+
+int main(int argc, char **argv){
+
+	const char *reporting = report_default_preset, *pcap_path = NULL, *udp_target = NULL;
+	uint32_t days = 1;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val) {
+			fprintf(stderr, "missing value for %s\n", arg);
+			return 2;
+		}
+		if (!strcmp(arg, "--devices")) device_count = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--days")) days = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--doors-per-day")) doors_per_day = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--reporting")) reporting = val;
+		else if (!strcmp(arg, "--pcap")) pcap_path = val;
+		else if (!strcmp(arg, "--udp")) udp_target = val;
+		else if (!strcmp(arg, "--speed")) speed = strtod(val, NULL);
+		else if (!strcmp(arg, "--seed")) rng_state = strtoul(val, NULL, 0) | 1;
+		else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return 2;
+		}
+		i++;
+	}
+
+	const struct report_cfg *cfg = report_preset_find(reporting);
+	if (!cfg) {
+		fprintf(stderr, "unknown reporting configuration %s\n", reporting);
+		return 2;
+	}
+
+	if ((device_count == 0) || (device_count > 0xE000)) {
+		fprintf(stderr, "--devices must be 1..%d\n", 0xE000);
+		return 2;
+	}
+
+	devices = calloc(device_count, sizeof(*devices));
+	heap = calloc(device_count, sizeof(*heap));
+	if (!devices || !heap) return 2;
+
+	if (pcap_path) pcap_open(pcap_path);
+	if (udp_target) udp_open(udp_target);
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+	for (uint32_t i = 0; i < device_count; i++) {
+		device_init(&devices[i], i, cfg);
+		device_update_due(&devices[i]);
+		heap[i] = i;
+	}
+	for (uint32_t i = device_count / 2; i-- > 0;) heap_down(i, device_count);
+
+	// always step the device that is due first, so the output is in time order
+	uint64_t end = days * 86400000ULL;
+	while (devices[heap[0]].due < end) {
+		device_step(&devices[heap[0]]);
+		heap_down(0, device_count);
+	}
+
+	for (uint32_t i = 0; i < device_count; i++) {
+		stats.rejected += devices[i].temp_filter.rejected + devices[i].humidity_filter.rejected;
+	}
+
+	uint64_t total = 0;
+	for (int i = 0; i <= REPORT_ATTR_COUNT; i++) total += stats.frames[i];
+
+	printf("%u devices, %u days, %s reporting\n", device_count, days, reporting);
+	printf("frames      %10llu  (%llu temperature, %llu humidity, %llu battery, %llu contact, "
+		"%llu On/Off)\n", (unsigned long long)total, (unsigned long long)stats.frames[REPORT_TEMP],
+		(unsigned long long)stats.frames[REPORT_HUMIDITY], (unsigned long long)stats.frames[REPORT_BATTERY],
+		(unsigned long long)stats.frames[REPORT_CONTACT], (unsigned long long)stats.frames[REPORT_ATTR_COUNT]);
+	printf("reports     %10llu on change, %llu periodic\n", (unsigned long long)stats.reasons[REPORT_CHANGE],
+		(unsigned long long)stats.reasons[REPORT_PERIODIC]);
+	printf("per device  %10.1f frames/day\n", total / (double)device_count / days);
+	printf("average     %10.2f frames/s, %.0f bytes/s\n", total / (days * 86400.0),
+		stats.bytes / (days * 86400.0));
+	printf("peak        %10u frames in one second (at %llu s)\n", stats.peak_per_sec,
+		(unsigned long long)stats.peak_at);
+	printf("rejected    %10u samples\n", stats.rejected);
+
+	if (pcap) fclose(pcap);
+	if (udp_sock >= 0) close(udp_sock);
+	free(devices);
+	free(heap);
+	return 0;
+}
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Stand-in coordinator for fleet_sim.
+
+Receives the frames of fleet_sim --udp (or reads a fleet_sim --pcap capture), checks the
+802.15.4 FCS, decodes NWK / APS / ZCL and converts the payload the way zicada_converter.js
+does (temperature and humidity in hundredths, battery in half percent, Binary Input
+present value and On/Off command to contact). Prints the received rate every second and a
+summary with the delivery latency, lost frames (APS counter gaps) and the last state of a
+few devices.
+
+usage:
+    fleet_sink.py [--port 17754] [--duration S]     listen for fleet_sim --udp 127.0.0.1:17754
+    fleet_sink.py --pcap fleet.pcap                 decode a capture
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+UDP_MAGIC = 0x5A464C54
+PCAP_LINKTYPE_802154_FCS = 195
+
+
+def fcs(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+def decode(frame):
+    """802.15.4 frame -> (source address, APS counter, converted values) or None"""
+    if len(frame) < 5 or fcs(frame[:-2]) != struct.unpack_from("<H", frame, len(frame) - 2)[0]:
+        return None
+    # MAC header of fleet_sim frames: fc, seq, PAN, dst, src (PAN id compression)
+    src = struct.unpack_from("<H", frame, 7)[0]
+    nwk = 9
+    aps = nwk + 8
+    _, _, cluster, _, _, counter = struct.unpack_from("<BBHHBB", frame, aps)
+    zcl = frame[aps + 8:-2]
+    fc, _, cmd = zcl[0], zcl[1], zcl[2]
+
+    if fc & 0x03 == 0x01:
+        # cluster-specific: the contact On/Off commands
+        if cluster == 0x0006 and cmd in (0x00, 0x01):
+            return src, counter, {"contact": cmd == 0x00}
+        return src, counter, {}
+
+    values = {}
+    if cmd == 0x0A:
+        attr, attr_type = struct.unpack_from("<HB", zcl, 3)
+        if attr_type in (0x10, 0x20):
+            raw = zcl[6]
+        elif attr_type == 0x29:
+            raw = struct.unpack_from("<h", zcl, 6)[0]
+        else:
+            raw = struct.unpack_from("<H", zcl, 6)[0]
+        if cluster == 0x0402 and attr == 0x0000:
+            values["temperature"] = raw / 100
+        elif cluster == 0x0405 and attr == 0x0000:
+            values["humidity"] = raw / 100
+        elif cluster == 0x0001 and attr == 0x0021:
+            values["battery"] = raw / 2
+        elif cluster == 0x000F and attr == 0x0055:
+            values["contact"] = bool(raw)
+    return src, counter, values
+
+
+class Sink:
+    def __init__(self):
+        self.frames = 0
+        self.bad = 0
+        self.lost = 0
+        self.latency = []
+        self.counters = {}
+        self.state = {}
+
+    def add(self, frame, latency=None):
+        res = decode(frame)
+        if res is None:
+            self.bad += 1
+            return
+        src, counter, values = res
+        self.frames += 1
+        last = self.counters.get(src)
+        if last is not None:
+            self.lost += (counter - last - 1) & 0xFF
+        self.counters[src] = counter
+        self.state.setdefault(src, {}).update(values)
+        if latency is not None:
+            self.latency.append(latency)
+
+    def summary(self, seconds):
+        print(f"{self.frames} frames from {len(self.state)} devices in {seconds:.1f} s "
+              f"({self.frames / max(seconds, 1e-9):.1f} frames/s), {self.bad} bad, {self.lost} lost")
+        if self.latency:
+            lat = sorted(self.latency)
+            pick = lambda q: lat[min(len(lat) - 1, int(q * len(lat)))] * 1000
+            print(f"latency ms: p50 {pick(0.5):.3f}  p99 {pick(0.99):.3f}  max {lat[-1] * 1000:.3f}")
+        for src in sorted(self.state)[:5]:
+            print(f"  0x{src:04x} {self.state[src]}")
+
+
+def read_pcap(path, sink):
+    with open(path, "rb") as f:
+        hdr = f.read(24)
+        magic, _, _, _, _, linktype = struct.unpack("<IIIIII", hdr)
+        if magic != 0xA1B2C3D4 or linktype != PCAP_LINKTYPE_802154_FCS:
+            sys.exit(f"{path}: not an 802.15.4 (with FCS) pcap")
+        first = last = None
+        while True:
+            rec = f.read(16)
+            if len(rec) < 16:
+                break
+            sec, usec, incl, _ = struct.unpack("<IIII", rec)
+            sink.add(f.read(incl))
+            ts = sec + usec / 1e6
+            first = ts if first is None else first
+            last = ts
+    sink.summary((last - first) if first is not None else 0)
+
+
+def listen(port, duration, sink):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 << 20)
+    sock.bind(("127.0.0.1", port))
+    sock.settimeout(1.0)
+    start = tick = time.monotonic()
+    count = 0
+    try:
+        while duration is None or time.monotonic() - start < duration:
+            try:
+                data = sock.recv(256)
+            except socket.timeout:
+                data = None
+            now = time.monotonic()
+            if data and len(data) > 24:
+                magic, _, _, sent_ns = struct.unpack_from("<IIQQ", data)
+                if magic == UDP_MAGIC:
+                    sink.add(data[24:], time.time() - sent_ns / 1e9)
+                    count += 1
+            if now - tick >= 1.0:
+                print(f"{count} frames/s", flush=True)
+                count = 0
+                tick = now
+    except KeyboardInterrupt:
+        pass
+    sink.summary(time.monotonic() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in coordinator for fleet_sim.")
+    parser.add_argument("--port", type=int, default=17754, help="UDP port to listen on")
+    parser.add_argument("--duration", type=float, help="stop after this many seconds")
+    parser.add_argument("--pcap", help="decode a fleet_sim capture instead of listening")
+    args = parser.parse_args()
+
+    sink = Sink()
+    if args.pcap:
+        read_pcap(args.pcap, sink)
+    else:
+        listen(args.port, args.duration, sink)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,559 @@
+// Host power simulator: battery life projection and power regression benchmarks
+//
+// Replays the firmware's schedule (src/app_sched.c) over a sensor / door trace, runs every
+// measurement through the firmware's filter (src/sensor_filter.c) and applies the ZBOSS
+// reporting rules with the firmware's own reporting configuration (sim_common/report_model.c).
+// The synthetic traces follow the shared climate model (sim_common/climate.c). Each wake-up,
+// sample and frame is charged from a per-event charge model.
+//
+// usage: power_sim [options]
+//   --scenario NAME      built-in synthetic trace: climate, door, glitch, degraded (no sensor)
+//                        (default: climate)
+//   --trace FILE         replay a recorded trace instead (CSV: seconds,kind,value with kind
+//                        temp / humidity in hundredths or contact 0/1)
+//   --days N             simulated time for synthetic traces (default 7)
+//   --model FILE         charge model (default: charge_model.txt next to the binary's cwd)
+//   --capacity MAH       battery capacity (default 800, AAA NiMH)
+//   --self-discharge PCT cell self-discharge per year (default 15, low self-discharge NiMH)
+//   --charge PCT         state of charge at the start (default 90), the reported battery
+//                        level follows the charge used through the firmware's NiMH curve
+//   --check FILE         run all built-in scenarios and compare against the baselines,
+//                        exits with 1 if a metric exceeds its limit
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "zicada_params.h"
+#include "sensor_filter.h"
+#include "app_sched.h"
+#include "persist_policy.h"
+#include "battery_level.h"
+#include "report_model.h"
+#include "climate.h"
+
+// room of the synthetic traces in the climate model
+#define CLIMATE_ROOM 1
+
+// LF clock accuracy the poll interval is fitted to, the crystal's spec
+#define LFCLK_ACCURACY_PPM 250
+
+// contact flash of the LED pattern engine (led_pattern.c)
+#define CONTACT_LED_MS 500
+
+#define SEC(msec) ((msec) / 1000)
+
+//---------------------------------------------------------------------------------------------
+// charge model, all values in uC (uA * s) per event except the sleep current
+//
+
+struct charge_model {
+	double sleep_ua;		// system ON idle with RTC and RAM retention
+	double wake_uc;			// CPU wake-up including HFCLK start
+	double sample_uc;		// one HDC2080 conversion and I2C transfer
+	double adc_uc;			// one SAADC battery measurement
+	double tx_uc;			// one frame sent including CSMA and MAC ack
+	double poll_uc;			// one data request to the parent
+	double nvram_uc;		// one NVRAM dataset write
+	double led_ua;			// LED current while lit
+};
+
+static struct charge_model model = {
+	.sleep_ua = 5.0,
+	.wake_uc = 6.0,
+	.sample_uc = 1.5,
+	.adc_uc = 1.0,
+	.tx_uc = 40.0,
+	.poll_uc = 30.0,
+	.nvram_uc = 60.0,
+	.led_ua = 1000.0,
+};
+
+static int load_model(const char *path){
+
+	FILE *f = fopen(path, "r");
+	if (!f) return -1;
+
+	char line[128], key[64];
+	double val;
+	while (fgets(line, sizeof(line), f)) {
+		if ((line[0] == '#') || (sscanf(line, "%63s %lf", key, &val) != 2)) continue;
+		if (!strcmp(key, "sleep_ua")) model.sleep_ua = val;
+		else if (!strcmp(key, "wake_uc")) model.wake_uc = val;
+		else if (!strcmp(key, "sample_uc")) model.sample_uc = val;
+		else if (!strcmp(key, "adc_uc")) model.adc_uc = val;
+		else if (!strcmp(key, "tx_uc")) model.tx_uc = val;
+		else if (!strcmp(key, "poll_uc")) model.poll_uc = val;
+		else if (!strcmp(key, "nvram_uc")) model.nvram_uc = val;
+		else if (!strcmp(key, "led_ua")) model.led_ua = val;
+		else fprintf(stderr, "%s: unknown key %s\n", path, key);
+	}
+	fclose(f);
+	return 0;
+}
+
+//---------------------------------------------------------------------------------------------
+// traces
+//
+
+enum trace_kind { TRACE_TEMP, TRACE_HUMIDITY, TRACE_CONTACT };
+
+struct trace_evt {
+	uint32_t t;				// seconds
+	uint8_t kind;
+	int32_t value;
+};
+
+struct trace {
+	struct trace_evt *evt;
+	size_t count, cap;
+	uint32_t duration;
+	double noise;			// per-sample noise added to climate values (hundredths, synthetic only)
+	double glitch_rate;		// probability of a corrupted sample (synthetic only)
+	bool sensor_missing;	// degraded mode, the sensor was not found at boot
+};
+
+static void trace_add(struct trace *tr, uint32_t t, uint8_t kind, int32_t value){
+
+	if (tr->count == tr->cap) {
+		tr->cap = tr->cap ? tr->cap * 2 : 1024;
+		tr->evt = realloc(tr->evt, tr->cap * sizeof(*tr->evt));
+		if (!tr->evt) exit(2);
+	}
+	tr->evt[tr->count++] = (struct trace_evt){ t, kind, value };
+	if (t > tr->duration) tr->duration = t;
+}
+
+// deterministic generator so that benchmark results are reproducible
+static uint32_t rng_state;
+
+static uint32_t rng(void){
+
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+static double rng_unit(void){
+
+	return (rng() & 0xFFFFFF) / (double)0x1000000;
+}
+
+static int synth_trace(struct trace *tr, const char *scenario, uint32_t days){
+
+	uint32_t door_per_day = 0;
+
+	rng_state = 0x5A1CADA;
+	tr->noise = 3;
+	tr->glitch_rate = 0;
+	tr->sensor_missing = false;
+
+	if (!strcmp(scenario, "door")) door_per_day = 24;
+	else if (!strcmp(scenario, "glitch")) tr->glitch_rate = 0.01;
+	else if (!strcmp(scenario, "degraded")) {
+		door_per_day = 24;
+		tr->sensor_missing = true;
+	} else if (strcmp(scenario, "climate")) return -1;
+
+	// indoor climate, one point every minute
+	struct climate room;
+	climate_init(&room, CLIMATE_ROOM);
+	for (uint32_t t = 0; t < days * 86400; t += 60) {
+		trace_add(tr, t, TRACE_TEMP, climate_temperature(&room, t));
+		trace_add(tr, t, TRACE_HUMIDITY, climate_humidity(&room, t));
+	}
+
+	// open / close pairs at random times during the day
+	for (uint32_t d = 0; d < days; d++) {
+		for (uint32_t i = 0; i < door_per_day / 2; i++) {
+			uint32_t t = d * 86400 + 6 * 3600 + rng() % (16 * 3600);
+			trace_add(tr, t, TRACE_CONTACT, 1);
+			trace_add(tr, t + 5 + rng() % 120, TRACE_CONTACT, 0);
+		}
+	}
+	tr->duration = days * 86400;
+	return 0;
+}
+
+static int load_trace(struct trace *tr, const char *path){
+
+	FILE *f = fopen(path, "r");
+	if (!f) return -1;
+
+	char line[128], kind[16];
+	unsigned long t;
+	long value;
+	while (fgets(line, sizeof(line), f)) {
+		if ((line[0] == '#') || (sscanf(line, "%lu,%15[^,],%ld", &t, kind, &value) != 3)) continue;
+		if (!strcmp(kind, "temp")) trace_add(tr, t, TRACE_TEMP, value);
+		else if (!strcmp(kind, "humidity")) trace_add(tr, t, TRACE_HUMIDITY, value);
+		else if (!strcmp(kind, "contact")) trace_add(tr, t, TRACE_CONTACT, value);
+	}
+	fclose(f);
+	return 0;
+}
+
+static int cmp_evt(const void *a, const void *b){
+
+	const struct trace_evt *x = a, *y = b;
+	return (x->t > y->t) - (x->t < y->t);
+}
+
+//---------------------------------------------------------------------------------------------
+// simulation
+//
+
+struct sim_result {
+	double days;
+	uint32_t wakeups;
+	uint32_t frames;
+	uint32_t samples;
+	uint32_t rejected;
+	uint32_t nvram_writes;
+	uint32_t adc;			// battery measurements
+	uint32_t polls;
+	uint32_t led_ms;
+	double uc;				// total charge
+};
+
+static double self_discharge_pct = 15;
+static double start_charge_pct = 90;
+
+// charge used by the events counted so far over secs seconds
+static double sim_charge(const struct sim_result *res, uint32_t secs){
+
+	return secs * model.sleep_ua +
+		res->wakeups * model.wake_uc +
+		res->samples * model.sample_uc +
+		res->adc * model.adc_uc +
+		res->frames * model.tx_uc +
+		res->polls * model.poll_uc +
+		res->nvram_writes * model.nvram_uc +
+		res->led_ms / 1000.0 * model.led_ua;
+}
+
+// battery percentage remaining attribute (ZCL half percent) after secs seconds: the cell
+// voltage at the charge left, converted like a measurement of check_battery_level()
+static uint8_t battery_attr(const struct sim_result *res, uint32_t secs, double capacity_mah){
+
+	double capacity_uc = capacity_mah * 1000.0 * 3600.0;
+	double self_uc = capacity_uc * self_discharge_pct / 100.0 * secs / (365.0 * 86400);
+	double used_uc = sim_charge(res, secs) + self_uc;
+	double permille = start_charge_pct * 10.0 - used_uc / capacity_uc * 1000.0;
+	if (permille < 0) permille = 0;
+	return (uint8_t)(NiMH_CalculateLevel(NiMH_CalculateVoltage((uint16_t)permille)) * 2);
+}
+
+static int32_t sample_value(int32_t base, const struct trace *tr){
+
+	if ((tr->glitch_rate > 0) && (rng_unit() < tr->glitch_rate)) {
+		// I2C glitch: all ones or a wild jump
+		return (rng() & 1) ? HDC2080_TEMPERATURE_MAX + 1 : base + 3000;
+	}
+	return base + (int32_t)((rng_unit() - 0.5) * 2 * tr->noise);
+}
+
+static void simulate(struct trace *tr, double capacity_mah, struct sim_result *res){
+
+	static const struct sensor_filter_cfg temp_cfg = {
+		HDC2080_TEMPERATURE_MIN, HDC2080_TEMPERATURE_MAX, CONFIG_ZICADA_FILTER_TEMP_MAX_STEP,
+		CONFIG_ZICADA_FILTER_MAX_REJECTS, CONFIG_ZICADA_FILTER_EMA_SHIFT };
+	static const struct sensor_filter_cfg humidity_cfg = {
+		HDC2080_HUMIDITY_MIN, HDC2080_HUMIDITY_MAX, CONFIG_ZICADA_FILTER_HUMIDITY_MAX_STEP,
+		CONFIG_ZICADA_FILTER_MAX_REJECTS, CONFIG_ZICADA_FILTER_EMA_SHIFT };
+
+	// a device that was never configured reports with the firmware's defaults
+	const struct report_cfg *cfg = report_preset_find("firmware");
+	struct sensor_filter temp_filter, humidity_filter;
+	struct report_attr temp = { .cfg = &cfg[REPORT_TEMP] }, humidity = { .cfg = &cfg[REPORT_HUMIDITY] },
+		battery = { .cfg = &cfg[REPORT_BATTERY] };
+	// contact state attribute (Binary Input present value), known from boot
+	struct report_attr contact = { .cfg = &cfg[REPORT_CONTACT], .valid = true };
+	int32_t env_temp = 2000, env_humidity = 5000;
+	// persisted state and the firmware's write policy (persist.c)
+	struct persist_data persisted = { .version = PERSIST_VERSION };
+	struct persist_policy persist;
+	size_t next = 0;
+
+	sensor_filter_init(&temp_filter, &temp_cfg);
+	sensor_filter_init(&humidity_filter, &humidity_cfg);
+	memset(res, 0, sizeof(*res));
+	qsort(tr->evt, tr->count, sizeof(*tr->evt), cmp_evt);
+
+	// configuring reporting at the join marks the reporting state
+	persist_policy_init(&persist);
+	persisted.flags |= PERSIST_FLAG_REPORTING_CONFIGURED;
+	persist_policy_mark(&persist, PERSIST_DIRTY_CONFIG);
+
+	// joined with a fresh state, the wake-ups come from the firmware's schedule
+	struct app_state app = { .joined = true, .sensor_ok = !tr->sensor_missing };
+	uint32_t next_wake[APP_WAKE_COUNT];
+	for (int w = 0; w < APP_WAKE_COUNT; w++) next_wake[w] = SEC(app_sched_first(w, &app));
+	uint32_t poll_interval = SEC(app_sched_poll_interval(LFCLK_ACCURACY_PPM));
+	uint32_t next_poll = poll_interval;
+	// time syncs, the interval grows from the minimum while the time holds
+	uint32_t next_sync = 0, sync_interval = TIME_SYNC_MIN_INTERVAL_MSEC;
+	bool synced = false;
+
+	// one step per second, a wake-up is any second with work to do
+	for (uint32_t now = 0; now < tr->duration; now++) {
+		bool woke = false;
+
+		while ((next < tr->count) && (tr->evt[next].t <= now)) {
+			struct trace_evt *e = &tr->evt[next++];
+			if (e->kind == TRACE_TEMP) env_temp = e->value;
+			else if (e->kind == TRACE_HUMIDITY) env_humidity = e->value;
+			else {
+				// hall interrupt: On/Off command on both edges and a contact flash,
+				// the attribute report follows from report_check()
+				woke = true;
+				res->frames++;
+				res->led_ms += CONTACT_LED_MS;
+				contact.value = !contact.value;
+			}
+		}
+
+		for (int w = 0; w < APP_WAKE_COUNT; w++) {
+			if (now < next_wake[w]) continue;
+
+			uint32_t jobs = app_sched_jobs(w, &app);
+			woke = true;
+
+			// a due time sync rides on this wake-up: the request and a poll for the answer,
+			// the time is assumed to hold so the interval grows
+			if ((jobs & APP_JOB_TIME_SYNC) && (now >= next_sync)) {
+				res->frames++;
+				res->polls++;
+				if (synced) {
+					sync_interval = app_sched_sync_interval(sync_interval, 0,
+						CONFIG_ZICADA_TIMEBASE_ACCURACY_MS);
+				}
+				synced = true;
+				next_sync = now + SEC(sync_interval);
+			}
+
+			if (jobs & APP_JOB_SAMPLE) {
+				int32_t t_burst[SENSOR_FILTER_MAX_BURST], h_burst[SENSOR_FILTER_MAX_BURST];
+				int32_t out;
+
+				for (int i = 0; i < CONFIG_ZICADA_FILTER_BURST; i++) {
+					t_burst[i] = sample_value(env_temp, tr);
+					h_burst[i] = sample_value(env_humidity, tr);
+				}
+				res->samples += CONFIG_ZICADA_FILTER_BURST;
+
+				if (sensor_filter_update(&temp_filter,
+						sensor_filter_median(t_burst, CONFIG_ZICADA_FILTER_BURST), &out)) {
+					temp.value = out;
+					temp.valid = true;
+				}
+				if (sensor_filter_update(&humidity_filter,
+						sensor_filter_median(h_burst, CONFIG_ZICADA_FILTER_BURST), &out)) {
+					humidity.value = out;
+					humidity.valid = true;
+				}
+				if (app.battery_phase < UINT8_MAX) app.battery_phase++;
+				persisted.temperature = (int16_t)temp.value;
+				persisted.humidity = (int16_t)humidity.value;
+				persisted.battery_phase = app.battery_phase;
+				persist_policy_mark(&persist, PERSIST_DIRTY_VALUES);
+			}
+
+			if (jobs & APP_JOB_BATTERY) {
+				res->adc++;
+				battery.value = battery_attr(res, now, capacity_mah);
+				battery.valid = true;
+				app.battery_phase = 0;
+				persisted.battery_percent = (uint8_t)battery.value;
+				persisted.battery_phase = 0;
+				persist_policy_mark(&persist, PERSIST_DIRTY_VALUES);
+			}
+
+			// persist_flush(), the writes always succeed
+			if ((jobs & APP_JOB_PERSIST) &&
+			    (persist_policy_check(&persist, &persisted, now * 1000LL) == PERSIST_WRITE)) {
+				res->nvram_writes++;
+				persist_policy_result(&persist, &persisted, true);
+			}
+
+			uint32_t delay = app_sched_next(w, &app);
+			next_wake[w] = delay ? now + SEC(delay) : UINT32_MAX;
+		}
+
+		if (now >= next_poll) {
+			woke = true;
+			next_poll = now + poll_interval;
+			res->polls++;
+		}
+
+		// reports go out from the same wake-up as the measurement, or on the max interval
+		struct report_attr *attrs[] = { &temp, &humidity, &battery, &contact };
+		uint32_t reports = 0;
+		for (size_t i = 0; i < sizeof(attrs) / sizeof(attrs[0]); i++) {
+			if (report_check(attrs[i], now * 1000ULL) != REPORT_NONE) reports++;
+		}
+		if (reports) woke = true;
+		res->frames += reports;
+
+		if (woke) res->wakeups++;
+	}
+
+	res->days = tr->duration / 86400.0;
+	res->rejected = temp_filter.rejected + humidity_filter.rejected;
+	res->uc = sim_charge(res, tr->duration);
+}
+
+//---------------------------------------------------------------------------------------------
+// reporting
+//
+
+struct metrics {
+	double wakeups_per_hour;
+	double frames_per_day;
+	double uah_per_day;
+	double life_days;
+	double nvram_writes_per_day;
+};
+
+static void metrics_get(const struct sim_result *res, double capacity_mah, struct metrics *m){
+
+	m->wakeups_per_hour = res->wakeups / (res->days * 24);
+	m->frames_per_day = res->frames / res->days;
+	m->uah_per_day = res->uc / 3600.0 / res->days;
+	m->nvram_writes_per_day = res->nvram_writes / res->days;
+
+	// the cell loses charge on its own, which dominates at these currents
+	double self_uah_per_day = capacity_mah * 1000.0 * self_discharge_pct / 100.0 / 365.0;
+	m->life_days = capacity_mah * 1000.0 / (m->uah_per_day + self_uah_per_day);
+}
+
+static void print_metrics(const char *name, const struct sim_result *res, const struct metrics *m){
+
+	printf("%-10s %6.2f wakeups/h  %7.1f frames/day  %7.1f uAh/day  %5.0f days  "
+		"(%u samples, %u rejected, %.1f NVRAM writes/day)\n", name, m->wakeups_per_hour,
+		m->frames_per_day, m->uah_per_day, m->life_days, res->samples, res->rejected,
+		m->nvram_writes_per_day);
+}
+
+static double metric_value(const struct metrics *m, const char *name){
+
+	if (!strcmp(name, "wakeups_per_hour")) return m->wakeups_per_hour;
+	if (!strcmp(name, "frames_per_day")) return m->frames_per_day;
+	if (!strcmp(name, "uah_per_day")) return m->uah_per_day;
+	if (!strcmp(name, "nvram_writes_per_day")) return m->nvram_writes_per_day;
+	return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+// baseline check: "scenario metric limit" per line, a metric above its limit fails
+//
+
+static int run_check(const char *path, uint32_t days, double capacity_mah){
+
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 2;
+	}
+
+	char line[128], scenario[32], metric[32], last[32] = "";
+	double limit;
+	struct metrics m = { 0 };
+	int failed = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		if ((line[0] == '#') || (sscanf(line, "%31s %31s %lf", scenario, metric, &limit) != 3)) continue;
+
+		// baselines are grouped by scenario, simulate each one once
+		if (strcmp(scenario, last)) {
+			struct trace tr = { 0 };
+			struct sim_result res;
+			if (synth_trace(&tr, scenario, days)) {
+				fprintf(stderr, "unknown scenario %s\n", scenario);
+				failed = 1;
+				continue;
+			}
+			simulate(&tr, capacity_mah, &res);
+			metrics_get(&res, capacity_mah, &m);
+			print_metrics(scenario, &res, &m);
+			free(tr.evt);
+			strcpy(last, scenario);
+		}
+
+		double value = metric_value(&m, metric);
+		if (value < 0) {
+			fprintf(stderr, "unknown metric %s\n", metric);
+			failed = 1;
+		} else if (value > limit) {
+			printf("FAIL %s %s: %.2f > %.2f\n", scenario, metric, value, limit);
+			failed = 1;
+		}
+	}
+	fclose(f);
+
+	if (!failed) printf("all metrics within baselines\n");
+	return failed;
+}
+
+//---------------------------------------------------------------------------------------------
+// main
+//
+
+int main(int argc, char **argv){
+
+	const char *scenario = "climate", *trace_path = NULL, *check_path = NULL;
+	const char *model_path = "charge_model.txt";
+	uint32_t days = 7;
+	double capacity_mah = 800;
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (!val) {
+			fprintf(stderr, "missing value for %s\n", arg);
+			return 2;
+		}
+		if (!strcmp(arg, "--scenario")) scenario = val;
+		else if (!strcmp(arg, "--trace")) trace_path = val;
+		else if (!strcmp(arg, "--days")) days = strtoul(val, NULL, 0);
+		else if (!strcmp(arg, "--model")) model_path = val;
+		else if (!strcmp(arg, "--capacity")) capacity_mah = strtod(val, NULL);
+		else if (!strcmp(arg, "--self-discharge")) self_discharge_pct = strtod(val, NULL);
+		else if (!strcmp(arg, "--charge")) start_charge_pct = strtod(val, NULL);
+		else if (!strcmp(arg, "--check")) check_path = val;
+		else {
+			fprintf(stderr, "unknown option %s\n", arg);
+			return 2;
+		}
+		i++;
+	}
+
+	if (load_model(model_path)) fprintf(stderr, "no charge model at %s, using defaults\n", model_path);
+
+	if (check_path) return run_check(check_path, days, capacity_mah);
+
+	struct trace tr = { 0 };
+	struct sim_result res;
+	struct metrics m;
+
+	if (trace_path) {
+		if (load_trace(&tr, trace_path)) {
+			fprintf(stderr, "cannot open %s\n", trace_path);
+			return 2;
+		}
+		rng_state = 0x5A1CADA;
+		scenario = trace_path;
+	} else if (synth_trace(&tr, scenario, days)) {
+		fprintf(stderr, "unknown scenario %s\n", scenario);
+		return 2;
+	}
+
+	simulate(&tr, capacity_mah, &res);
+	metrics_get(&res, capacity_mah, &m);
+	print_metrics(scenario, &res, &m);
+	free(tr.evt);
+	return 0;
+}
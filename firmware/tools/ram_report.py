@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Report which nRF52840 RAM sections stay powered and their retention current.
+
+power_down_unused_ram() switches off every RAM section above the end of the image's
+RAM (_end), so the standby current depends on how far the linked data reaches. This
+script reads zephyr.elf, lists the RAM output sections, marks the powered sections
+and estimates their retention current. The firmware build runs it after every link
+and writes the report to build/zephyr/ram_report.txt.
+
+Usage: ram_report.py zephyr.elf [-o ram_report.txt] [--na-per-kb 6.5]
+"""
+
+import argparse
+import sys
+
+try:
+    from elftools.elf.elffile import ELFFile
+    from elftools.elf.sections import SymbolTableSection
+except ImportError:
+    # part of the Zephyr python requirements, skip quietly elsewhere
+    print("ram_report.py: pyelftools not installed, no RAM report")
+    sys.exit(0)
+
+RAM_START = 0x20000000
+
+# nRF52840: RAM0..RAM7 with two 4 KB sections each, then RAM8 with six 32 KB sections
+RAM_SECTIONS = [4096] * 16 + [32768] * 6
+
+# retention current per KB from the product specification: system ON with full 256 KB
+# retention (3.16 uA) minus no retention (1.5 uA)
+NA_PER_KB = (3.16 - 1.5) * 1000 / 256
+
+# symbols of interest, the first one found marks the end of the used RAM
+END_SYMBOLS = ("_end", "_image_ram_end", "__kernel_ram_end")
+
+
+def symbols(elf):
+    table = elf.get_section_by_name(".symtab")
+    if not isinstance(table, SymbolTableSection):
+        sys.exit("no symbol table in the ELF file")
+    return {sym.name: sym["st_value"] for sym in table.iter_symbols() if sym.name}
+
+
+def ram_sections(elf):
+    out = []
+    for sec in elf.iter_sections():
+        addr, size = sec["sh_addr"], sec["sh_size"]
+        if size and (sec["sh_flags"] & 0x2) and RAM_START <= addr < RAM_START + sum(RAM_SECTIONS):
+            out.append((addr, size, sec.name))
+    return sorted(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("-o", "--output", help="also write the report to this file")
+    parser.add_argument("--na-per-kb", type=float, default=NA_PER_KB,
+                        help="retention current per KB in nA (default %(default).2f)")
+    args = parser.parse_args()
+
+    with open(args.elf, "rb") as f:
+        elf = ELFFile(f)
+        syms = symbols(elf)
+        sections = ram_sections(elf)
+
+    end = next((syms[s] for s in END_SYMBOLS if s in syms), None)
+    if end is None:
+        end = max(addr + size for addr, size, _ in sections)
+
+    lines = ["RAM output sections:"]
+    for addr, size, name in sections:
+        lines.append("  0x%08x %7d  %s" % (addr, size, name))
+
+    if "_zicada_retained_start" in syms:
+        start, stop = syms["_zicada_retained_start"], syms["_zicada_retained_end"]
+        lines.append("retained block: 0x%08x, %d bytes" % (start, stop - start))
+
+    lines.append("")
+    lines.append("RAM sections (powered up to 0x%08x):" % end)
+    addr, powered, powered_kb, headroom = RAM_START, 0, 0, 0
+    for i, size in enumerate(RAM_SECTIONS):
+        on = addr < end
+        if on:
+            powered += 1
+            powered_kb += size // 1024
+            if addr + size >= end:
+                headroom = addr + size - end
+        lines.append("  %2d 0x%08x %3d KB  %s" % (i, addr, size // 1024, "on" if on else "off"))
+        addr += size
+
+    used = end - RAM_START
+    lines.append("")
+    lines.append("used %d bytes, %d of %d sections on (%d KB), %d bytes left in the last one"
+                 % (used, powered, len(RAM_SECTIONS), powered_kb, headroom))
+    lines.append("estimated retention current: %.0f nA (%.2f nA per KB)"
+                 % (powered_kb * args.na_per_kb, args.na_per_kb))
+
+    report = "\n".join(lines) + "\n"
+    print(report, end="")
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(report)
+
+
+if __name__ == "__main__":
+    main()
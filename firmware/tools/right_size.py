@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Derive tightened stack and heap sizes from recorded high-water marks.
+
+With CONFIG_ZICADA_MEM_STATS the firmware prints its high-water marks over RTT with
+each battery check:
+
+    MEM <thread> <size> <used>
+    MEM heap <size> <max used>
+
+Capture them from worst-case runs (join, rejoin, factory reset, OTA, heavy door
+traffic) and pass the captures (files or directories) to this script. It takes
+the largest use of every thread over all captures, adds a safety margin and writes
+a Kconfig overlay. The firmware build applies it with -DZICADA_RIGHT_SIZE=ON.
+
+With CONFIG_ZICADA_RES_STATS the captures also hold the ZBOSS resource headroom:
+
+    RES <resource> <size> <min free> <failures>
+
+The ZBOSS pools are sized in include/zb_mem_config_custom.h rather than Kconfig, so
+for these the script only prints suggested values.
+
+Usage: right_size.py capture.txt|dir [...] [-o overlay-rightsize.conf] [--margin 25]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# thread name -> Kconfig symbol of its stack size
+SYMBOLS = {
+    "zboss": "CONFIG_ZBOSS_DEFAULT_THREAD_STACK_SIZE",
+    "main": "CONFIG_MAIN_STACK_SIZE",
+    "logging": "CONFIG_LOG_PROCESS_THREAD_STACK_SIZE",
+    "sysworkq": "CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE",
+    "idle": "CONFIG_IDLE_STACK_SIZE",
+    "heap": "CONFIG_HEAP_MEM_POOL_SIZE",
+}
+
+# stacks are aligned to the MPU region granularity, keep sizes a multiple of this
+ALIGN = 64
+
+# lower bound so that a capture without activity cannot shrink a stack to nothing, the heap
+# keeps more room because fragmentation does not show in the peak
+MIN_SIZE = 256
+MIN_HEAP_SIZE = 1024
+
+# RAM is powered down in 4 KB sections by power_down_unused_ram()
+RAM_SECTION = 4096
+
+MEM_RE = re.compile(r"\bMEM (\w+) (\d+) (\d+)\s*$")
+RES_RE = re.compile(r"\bRES (\w+) (\d+) (\d+) (\d+)\s*$")
+
+# ZBOSS resource -> zb_mem_config_custom.h define, the buffer pool is shared by both
+# directions and each may take half of it
+RES_DEFINES = {
+    "alarm_q": "ZB_CONFIG_SCHEDULER_Q_SIZE",
+    "buf_in": "ZB_CONFIG_IOBUF_POOL_SIZE",
+    "buf_out": "ZB_CONFIG_IOBUF_POOL_SIZE",
+}
+
+# ZBOSS needs a few entries of its own, below this the stack itself may fail
+MIN_RES_SIZE = 8
+
+
+def captures(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for name in sorted(os.listdir(path)):
+                full = os.path.join(path, name)
+                if os.path.isfile(full) and name.endswith((".txt", ".log")):
+                    yield full
+        else:
+            yield path
+
+
+def collect(paths):
+    sizes, used, files = {}, {}, 0
+    res = {}
+    for path in captures(paths):
+        files += 1
+        with open(path, encoding="utf-8", errors="replace") as f:
+            for line in f:
+                m = RES_RE.search(line)
+                if m:
+                    name, size, free, fails = m.group(1), *map(int, m.group(2, 3, 4))
+                    old = res.get(name, (size, size, 0))
+                    res[name] = (size, min(old[1], free), max(old[2], fails))
+                    continue
+                m = MEM_RE.search(line)
+                if not m:
+                    continue
+                name, size, peak = m.group(1), int(m.group(2)), int(m.group(3))
+                sizes[name] = size
+                used[name] = max(used.get(name, 0), peak)
+    return sizes, used, res, files
+
+
+def report_res(res, margin):
+    """Print the ZBOSS headroom and suggested zb_mem_config_custom.h values."""
+    suggest = {}
+    print("%-10s %8s %8s %8s %8s" % ("", "size", "used", "fails", "suggest"))
+    for name in sorted(res):
+        size, free, fails = res[name]
+        used = size - free
+        if name == "sched_q":
+            # the callback queue cannot be probed, only its failures are known
+            print("%-10s %8s %8s %8d" % (name, "-", "-", fails))
+            continue
+        if name not in RES_DEFINES:
+            print("%-10s %8d %8d %8d" % (name, size, used, fails))
+            continue
+        # a failure means the probes missed the peak, keep the size then. The alarm table
+        # shares its size with the callback queue, which counts failures only.
+        if name == "alarm_q":
+            fails += res.get("sched_q", (0, 0, 0))[2]
+        new = size if fails else max(-(-used * (100 + margin) // 100), MIN_RES_SIZE)
+        if name.startswith("buf_"):
+            new *= 2
+        define = RES_DEFINES[name]
+        suggest[define] = max(suggest.get(define, 0), new)
+        print("%-10s %8d %8d %8d %8d" % (name, size, used, fails, new))
+    for define, value in sorted(suggest.items()):
+        print("#define %s %d" % (define, value))
+    print()
+
+
+def tightened(name, peak, margin):
+    size = peak * (100 + margin) // 100
+    size = (size + ALIGN - 1) // ALIGN * ALIGN
+    return max(size, MIN_HEAP_SIZE if name == "heap" else MIN_SIZE)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("captures", nargs="+", help="RTT captures or directories of captures")
+    parser.add_argument("-o", "--output", default="overlay-rightsize.conf")
+    parser.add_argument("--margin", type=int, default=25, help="safety margin in percent")
+    args = parser.parse_args()
+
+    sizes, used, res, files = collect(args.captures)
+    if res:
+        report_res(res, args.margin)
+    if not used:
+        sys.exit("no MEM lines found, enable CONFIG_ZICADA_MEM_STATS and capture RTT")
+
+    lines = [
+        "# Generated by tools/right_size.py from %d capture(s), margin %d %%" % (files, args.margin),
+        "# Do not edit, record new worst-case runs instead.",
+    ]
+    saved = 0
+    print("%-10s %8s %8s %8s" % ("", "size", "peak", "new"))
+    for name in sorted(used):
+        if name not in SYMBOLS:
+            continue
+        new = tightened(name, used[name], args.margin)
+        if new >= sizes[name]:
+            new = sizes[name]
+        saved += sizes[name] - new
+        lines.append("%s=%d" % (SYMBOLS[name], new))
+        print("%-10s %8d %8d %8d" % (name, sizes[name], used[name], new))
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+
+    print("reclaimed %d bytes (%.1f RAM sections of 4 KB), written to %s"
+          % (saved, saved / RAM_SECTION, args.output))
+
+
+if __name__ == "__main__":
+    main()
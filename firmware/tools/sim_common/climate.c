@@ -0,0 +1,140 @@
+// Indoor climate of one room for the host simulators, see climate.h
+
+#include <math.h>
+
+#include "climate.h"
+
+//---------------------------------------------------------------------------------------------
+// defines
+//
+
+#define DAY_S					86400
+#define HOUR_S					3600
+
+// heated from 6:00 to 22:00, set back at night, the heating takes an hour to get there
+#define SETPOINT_DAY			2100
+#define SETPOINT_NIGHT			1850
+#define SETPOINT_RAMP_S			HOUR_S
+
+// the room swings around the set point between heating on and off
+#define HEAT_SWING				25
+
+// an opened window cools the room and dries the air within minutes, it takes longer to
+// come back
+#define AIRING_S				(10 * 60)
+#define AIRING_TEMP				-350
+#define AIRING_HUMIDITY			-1200
+#define AIRING_RECOVERY_S		(30 * 60)
+
+// a shower raises the humidity of a bathroom, which then vents out slowly
+#define SHOWER_S				(15 * 60)
+#define SHOWER_HUMIDITY			3000
+#define SHOWER_DECAY_S			(40 * 60)
+
+#define HUMIDITY_BASE			4500
+#define HUMIDITY_NIGHT			300
+
+//---------------------------------------------------------------------------------------------
+// helpers
+//
+
+// stateless hash, the same room, day and event always get the same value
+static uint32_t climate_hash(uint32_t seed, uint32_t a, uint32_t b){
+
+	uint32_t h = seed * 0x9E3779B1u ^ a * 0x85EBCA77u ^ b * 0xC2B2AE3Du;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6Du;
+	h ^= h >> 12;
+	h *= 0x297A2D39u;
+	h ^= h >> 15;
+	return h;
+}
+
+// 0 at night, 1 during the day, linear ramps in between
+static double daytime(const struct climate *c, uint64_t t_s){
+
+	int64_t s = (int64_t)((t_s + DAY_S - c->day_shift_s) % DAY_S);
+	int64_t up = 6 * HOUR_S, down = 22 * HOUR_S;
+
+	if ((s < up) || (s >= down + SETPOINT_RAMP_S)) return 0;
+	if (s < up + SETPOINT_RAMP_S) return (s - up) / (double)SETPOINT_RAMP_S;
+	if (s < down) return 1;
+	return 1 - (s - down) / (double)SETPOINT_RAMP_S;
+}
+
+// ramp to the full effect within rise_s, then an exponential return
+static double event_shape(int64_t dt, uint32_t rise_s, uint32_t decay_s){
+
+	if ((dt < 0) || (dt > rise_s + 8 * (int64_t)decay_s)) return 0;
+	if (dt < rise_s) return dt / (double)rise_s;
+	return exp(-(dt - rise_s) / (double)decay_s);
+}
+
+// effect of the airings of today and yesterday (its tail can reach past midnight)
+static double airing(const struct climate *c, uint64_t t_s){
+
+	uint64_t day = t_s / DAY_S;
+	double effect = 0;
+
+	for (uint64_t d = (day > 0) ? day - 1 : 0; d <= day; d++) {
+		for (uint32_t k = 0; k < c->airings; k++) {
+			uint64_t start = d * DAY_S + c->day_shift_s + 7 * HOUR_S +
+				climate_hash(c->seed, (uint32_t)d, 0x100 + k) % (14 * HOUR_S);
+			effect += event_shape((int64_t)(t_s - start), AIRING_S, AIRING_RECOVERY_S);
+		}
+	}
+	return (effect > 1) ? 1 : effect;
+}
+
+static double shower(const struct climate *c, uint64_t t_s){
+
+	uint64_t day = t_s / DAY_S;
+	double effect = 0;
+
+	for (uint64_t d = (day > 0) ? day - 1 : 0; d <= day; d++) {
+		for (uint32_t k = 0; k < c->showers; k++) {
+			// mornings and evenings
+			uint64_t start = d * DAY_S + c->day_shift_s + (k ? 19 : 6) * HOUR_S + HOUR_S / 2 +
+				climate_hash(c->seed, (uint32_t)d, 0x200 + k) % HOUR_S;
+			effect += event_shape((int64_t)(t_s - start), SHOWER_S, SHOWER_DECAY_S);
+		}
+	}
+	return (effect > 1) ? 1 : effect;
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+void climate_init(struct climate *c, uint32_t seed){
+
+	c->seed = seed;
+	c->temp_offset = (int32_t)(climate_hash(seed, 0, 1) % 400) - 200;
+	c->humidity_offset = (int32_t)(climate_hash(seed, 0, 2) % 1200) - 600;
+	c->day_shift_s = climate_hash(seed, 0, 3) % (2 * HOUR_S);
+	c->heat_period_s = 90 * 60 + climate_hash(seed, 0, 4) % (90 * 60);
+	c->airings = climate_hash(seed, 0, 5) % 4;
+	// one room in four is a bathroom
+	c->showers = (climate_hash(seed, 0, 6) % 4 == 0) ? 1 + climate_hash(seed, 0, 7) % 2 : 0;
+}
+
+int32_t climate_temperature(const struct climate *c, uint64_t t_s){
+
+	double setpoint = SETPOINT_NIGHT + (SETPOINT_DAY - SETPOINT_NIGHT) * daytime(c, t_s);
+
+	// triangle between heating on and off
+	double phase = ((t_s + c->seed) % c->heat_period_s) / (double)c->heat_period_s;
+	double swing = HEAT_SWING * (fabs(phase * 2 - 1) * 2 - 1);
+
+	return (int32_t)lround(setpoint + c->temp_offset + swing + AIRING_TEMP * airing(c, t_s));
+}
+
+int32_t climate_humidity(const struct climate *c, uint64_t t_s){
+
+	double humidity = HUMIDITY_BASE + c->humidity_offset + HUMIDITY_NIGHT * (1 - daytime(c, t_s)) +
+		AIRING_HUMIDITY * airing(c, t_s) + SHOWER_HUMIDITY * shower(c, t_s);
+
+	if (humidity < 0) return 0;
+	if (humidity > 10000) return 10000;
+	return (int32_t)lround(humidity);
+}
@@ -0,0 +1,30 @@
+#ifndef __CLIMATE_H__
+#define __CLIMATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Indoor climate of one room for the host simulators
+//
+// Temperature and humidity in attribute units (hundredths) as the sensor would see them
+// without noise: a night setback, the swing of the heating around its set point, windows
+// opened for airing and, in bathrooms, showers. The changes cross the reportable change of
+// the converter's presets, so change-triggered and periodic reports both show up. Each room
+// follows from its seed, the same seed and time always give the same values.
+
+struct climate {
+	uint32_t seed;
+	int32_t temp_offset;		// set point offset of the room
+	int32_t humidity_offset;
+	uint32_t day_shift_s;		// when the household gets up, relative to 6:00
+	uint32_t heat_period_s;		// heating on / off cycle
+	uint8_t airings;			// windows opened per day
+	uint8_t showers;			// per day, bathrooms only
+};
+
+void climate_init(struct climate *c, uint32_t seed);
+
+int32_t climate_temperature(const struct climate *c, uint64_t t_s);
+int32_t climate_humidity(const struct climate *c, uint64_t t_s);
+
+#endif // __CLIMATE_H__
@@ -0,0 +1,76 @@
+// ZBOSS attribute reporting rules for the host simulators, see report_model.h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zicada_params.h"
+#include "report_model.h"
+#include "sim_presets.h"
+
+//---------------------------------------------------------------------------------------------
+// Globals
+//
+
+const char *const report_default_preset = REPORT_DEFAULT_PRESET;
+
+// configure_attribute_reporting() in main.c
+static const struct report_preset firmware_preset = { "firmware", {
+	[REPORT_TEMP]		= { RPT_MIN, RPT_MAX, 0 },
+	[REPORT_HUMIDITY]	= { RPT_MIN, RPT_MAX, 0 },
+	[REPORT_BATTERY]	= { RPT_MIN, RPT_MAX, 0 },
+	[REPORT_CONTACT]	= { RPT_MIN, CONTACT_RPT_MAX, 0 },
+} };
+
+//---------------------------------------------------------------------------------------------
+// rules
+//
+
+static bool change_due(const struct report_attr *a){
+
+	int32_t diff = abs(a->value - a->reported);
+	return (diff > 0) && (diff >= a->cfg->change);
+}
+
+static bool periodic(const struct report_cfg *cfg){
+
+	return (cfg->max_s != 0) && (cfg->max_s != 0xFFFF);
+}
+
+//---------------------------------------------------------------------------------------------
+// public interface
+//
+
+const struct report_cfg *report_preset_find(const char *name){
+
+	if (!strcmp(name, firmware_preset.name)) return firmware_preset.cfg;
+	for (size_t i = 0; i < sizeof(report_presets) / sizeof(report_presets[0]); i++) {
+		if (!strcmp(name, report_presets[i].name)) return report_presets[i].cfg;
+	}
+	return NULL;
+}
+
+uint64_t report_due(const struct report_attr *a){
+
+	if (!a->valid) return UINT64_MAX;
+	if (!a->sent) return 0;
+
+	uint64_t due = UINT64_MAX;
+	if (change_due(a)) due = a->last_report + a->cfg->min_s * 1000ULL;
+	if (periodic(a->cfg)) {
+		uint64_t heartbeat = a->last_report + a->cfg->max_s * 1000ULL;
+		if (heartbeat < due) due = heartbeat;
+	}
+	return due;
+}
+
+enum report_reason report_check(struct report_attr *a, uint64_t now_ms){
+
+	if (report_due(a) > now_ms) return REPORT_NONE;
+
+	// a value the coordinator does not have counts as a change, also the first one
+	enum report_reason reason = (!a->sent || change_due(a)) ? REPORT_CHANGE : REPORT_PERIODIC;
+	a->reported = a->value;
+	a->last_report = now_ms;
+	a->sent = true;
+	return reason;
+}
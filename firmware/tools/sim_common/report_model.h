@@ -0,0 +1,53 @@
+#ifndef __REPORT_MODEL_H__
+#define __REPORT_MODEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ZBOSS attribute reporting rules for the host simulators
+//
+// An attribute is reported when it moved by the reportable change (0: any change) and the
+// min interval has passed since the last report, and again after the max interval without
+// one (0 or 0xFFFF: no periodic reports). The first valid value is reported right away.
+// The configurations are the presets of zicada_converter.js (generated into sim_presets.h)
+// or the firmware's own, see configure_attribute_reporting() in main.c.
+
+enum report_attr_id { REPORT_TEMP, REPORT_HUMIDITY, REPORT_BATTERY, REPORT_CONTACT, REPORT_ATTR_COUNT };
+
+// why a report was sent
+enum report_reason { REPORT_NONE, REPORT_CHANGE, REPORT_PERIODIC, REPORT_REASON_COUNT };
+
+// reporting configuration of one attribute (Configure Reporting)
+struct report_cfg {
+	uint32_t min_s;
+	uint32_t max_s;
+	int32_t change;
+};
+
+struct report_preset {
+	const char *name;
+	struct report_cfg cfg[REPORT_ATTR_COUNT];
+};
+
+struct report_attr {
+	const struct report_cfg *cfg;
+	int32_t value;
+	int32_t reported;
+	uint64_t last_report;		// ms
+	bool valid;
+	bool sent;
+};
+
+// defaultReportingPreset of the converter
+extern const char *const report_default_preset;
+
+// reporting configuration by preset name, "firmware" for a device that was never configured
+const struct report_cfg *report_preset_find(const char *name);
+
+// earliest time in ms the attribute has to be looked at again, UINT64_MAX if never
+uint64_t report_due(const struct report_attr *a);
+
+// report the attribute if it is due, returns why
+enum report_reason report_check(struct report_attr *a, uint64_t now_ms);
+
+#endif // __REPORT_MODEL_H__
@@ -0,0 +1,28 @@
+# Shared part of the host simulator builds, included by their Makefiles after FW_DIR is set
+#
+# The Kconfig defaults and the converter's reporting presets are generated into gen/, so
+# the simulators follow the firmware and the converter instead of copies of them. The
+# reporting and climate models are shared by the simulators.
+
+empty      :=
+space      := $(empty) $(empty)
+
+SIM_DIR    = $(FW_DIR)/tools/sim_common
+GEN_DIR    = gen
+CONVERTER  = $(FW_DIR)/../z2m converter/zicada_converter.js
+
+CC        ?= cc
+CFLAGS     = -O2 -Wall -Wextra -std=c11 -I$(FW_DIR)/include -I$(SIM_DIR) -I$(GEN_DIR) \
+             -include sim_kconfig.h $(CFLAGS_EXTRA)
+
+SIM_SRCS   = $(FW_DIR)/src/sensor_filter.c $(FW_DIR)/src/app_sched.c $(FW_DIR)/src/persist_policy.c $(FW_DIR)/src/persist_store.c $(FW_DIR)/src/battery_level.c $(SIM_DIR)/report_model.c $(SIM_DIR)/climate.c
+SIM_GEN    = $(GEN_DIR)/sim_kconfig.h $(GEN_DIR)/sim_presets.h
+SIM_DEPS   = $(SIM_GEN) $(wildcard $(FW_DIR)/include/*.h) $(wildcard $(SIM_DIR)/*.h)
+
+$(GEN_DIR)/sim_kconfig.h: $(FW_DIR)/Kconfig $(SIM_DIR)/sim_config.py
+	@mkdir -p $(GEN_DIR)
+	python3 $(SIM_DIR)/sim_config.py kconfig $(FW_DIR)/Kconfig -o $@
+
+$(GEN_DIR)/sim_presets.h: $(subst $(space),\ ,$(CONVERTER)) $(SIM_DIR)/sim_config.py
+	@mkdir -p $(GEN_DIR)
+	python3 $(SIM_DIR)/sim_config.py presets "$(CONVERTER)" -o $@
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Generate the configuration headers of the host simulators from their sources.
+
+The simulators build the firmware's SDK-free code on the host, without Kconfig, and model
+the reporting that zicada_converter.js writes to the device. Instead of copies that drift,
+both are generated:
+
+    sim_config.py kconfig firmware/Kconfig -o sim_kconfig.h
+        #ifndef / #define for every ZICADA option with an unconditional default (bool y
+        becomes 1, options without a default stay undefined), so -D overrides still work
+
+    sim_config.py presets "z2m converter/zicada_converter.js" -o sim_presets.h
+        the reportingPresets table as struct report_preset entries (report_model.h)
+"""
+
+import argparse
+import re
+import sys
+
+CONFIG_RE = re.compile(r"^config\s+(ZICADA_\w+)\s*$")
+DEFAULT_RE = re.compile(r"^\s+default\s+(\S+)\s*$")
+ENDCONFIG_RE = re.compile(r"^(config|menuconfig|menu|endmenu|if|endif|choice|source|module)\b")
+
+PRESET_START_RE = re.compile(r"^const reportingPresets = \{\s*$")
+PRESET_NAME_RE = re.compile(r"^\s+(\w+): \{\s*$")
+PRESET_ATTR_RE = re.compile(r"^\s+(\w+): \{min: (\d+), max: (\d+)(?:, change: (\d+))?\},\s*$")
+PRESET_END_RE = re.compile(r"^\};\s*$")
+DEFAULT_PRESET_RE = re.compile(r'^const defaultReportingPreset = "(\w+)";')
+
+# converter attribute name -> enum report_attr_id
+ATTRS = {
+    "temperature": "REPORT_TEMP",
+    "humidity": "REPORT_HUMIDITY",
+    "battery": "REPORT_BATTERY",
+    "contact": "REPORT_CONTACT",
+}
+
+
+def kconfig_defaults(path):
+    options = []
+    name = None
+    with open(path) as f:
+        for line in f:
+            m = CONFIG_RE.match(line)
+            if m:
+                name = m.group(1)
+                continue
+            if name is None:
+                continue
+            if ENDCONFIG_RE.match(line):
+                name = None
+                continue
+            # the first default without a condition, conditional ones are for other builds
+            m = DEFAULT_RE.match(line)
+            if m:
+                value = m.group(1)
+                if value == "y":
+                    options.append((name, "1"))
+                elif value != "n":
+                    options.append((name, value))
+                name = None
+    return options
+
+
+def presets(path):
+    table = []
+    default = None
+    inside = False
+    with open(path) as f:
+        for line in f:
+            m = DEFAULT_PRESET_RE.match(line)
+            if m:
+                default = m.group(1)
+            if PRESET_START_RE.match(line):
+                inside = True
+                continue
+            if not inside:
+                continue
+            if PRESET_END_RE.match(line):
+                inside = False
+                continue
+            m = PRESET_NAME_RE.match(line)
+            if m:
+                table.append((m.group(1), {}))
+                continue
+            m = PRESET_ATTR_RE.match(line)
+            if m and table:
+                attr = m.group(1)
+                if attr not in ATTRS:
+                    sys.exit(f"{path}: unknown attribute {attr} in preset {table[-1][0]}")
+                table[-1][1][attr] = (m.group(2), m.group(3), m.group(4) or "0")
+    if not table or default is None:
+        sys.exit(f"{path}: reportingPresets or defaultReportingPreset not found")
+    for name, attrs in table:
+        if set(attrs) != set(ATTRS):
+            sys.exit(f"{path}: preset {name} does not set {', '.join(sorted(set(ATTRS) - set(attrs)))}")
+    return table, default
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("what", choices=["kconfig", "presets"])
+    parser.add_argument("source")
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    out = [f"// Generated by tools/sim_common/sim_config.py from {args.source.split('/')[-1]}, do not edit", ""]
+    if args.what == "kconfig":
+        for name, value in kconfig_defaults(args.source):
+            out += [f"#ifndef CONFIG_{name}", f"#define CONFIG_{name} {value}", "#endif"]
+    else:
+        table, default = presets(args.source)
+        out.append("static const struct report_preset report_presets[] = {")
+        for name, attrs in table:
+            out.append(f'\t{{ "{name}", {{')
+            for attr, enum in ATTRS.items():
+                out.append(f"\t\t[{enum}] = {{ {', '.join(attrs[attr])} }},")
+            out.append("\t} },")
+        out += ["};", "", f'#define REPORT_DEFAULT_PRESET "{default}"']
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
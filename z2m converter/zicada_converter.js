@@ -1,8 +1,88 @@
 import * as fz from "zigbee-herdsman-converters/converters/fromZigbee";
 import * as exposes from "zigbee-herdsman-converters/lib/exposes";
+import {logger} from "zigbee-herdsman-converters/lib/logger";
 import * as reporting from "zigbee-herdsman-converters/lib/reporting";
 
+const NS = "zhc:zicada";
 const e = exposes.presets;
+const ea = exposes.access;
+
+// Reporting presets written to the device with Configure Reporting.
+// Intervals in seconds, changes in attribute units: temperature and humidity in 1/100,
+// battery in 1/2 %, contact is the Binary Input present value (reported on every change,
+// max is the heartbeat). The firmware samples temperature & humidity every 5 minutes and the
+// battery every 6 hours, so shorter minimum intervals only speed up the first report.
+// firmware/tools/sim_common/sim_config.py reads this table for the simulators, keep one attribute per line
+const reportingPresets = {
+    low_airtime: {
+        temperature: {min: 900, max: 21600, change: 50},
+        humidity: {min: 900, max: 21600, change: 300},
+        battery: {min: 21600, max: 62000, change: 10},
+        contact: {min: 0, max: 43200},
+    },
+    balanced: {
+        temperature: {min: 300, max: 3600, change: 20},
+        humidity: {min: 300, max: 3600, change: 100},
+        battery: {min: 3600, max: 43200, change: 2},
+        contact: {min: 0, max: 14400},
+    },
+    responsive: {
+        temperature: {min: 10, max: 1800, change: 10},
+        humidity: {min: 10, max: 1800, change: 50},
+        battery: {min: 3600, max: 21600, change: 0},
+        contact: {min: 0, max: 3600},
+    },
+};
+const defaultReportingPreset = "balanced";
+
+async function configureReportingPreset(endpoint, name) {
+    const preset = reportingPresets[name];
+    if (!preset) {
+        throw new Error(`Unknown reporting preset '${name}'`);
+    }
+    await reporting.temperature(endpoint, preset.temperature);
+    await reporting.humidity(endpoint, preset.humidity);
+    await reporting.batteryPercentageRemaining(endpoint, preset.battery);
+    await endpoint.configureReporting("genBinaryInput", [{
+        attribute: "presentValue",
+        minimumReportInterval: preset.contact.min,
+        maximumReportInterval: preset.contact.max,
+        reportableChange: 0,
+    }]);
+}
+
+// The device sleeps between polls and misses a Configure Reporting sent meanwhile. The preset
+// stays pending in the device meta and is written again after the next report, while the
+// device is awake.
+const presetsApplying = new Set();
+
+async function applyPendingPreset(device, endpoint) {
+    if (!device.meta.reportingPresetPending || presetsApplying.has(device.ieeeAddr)) {
+        return;
+    }
+    presetsApplying.add(device.ieeeAddr);
+    try {
+        await configureReportingPreset(endpoint, device.meta.reportingPreset);
+        device.meta.reportingPresetPending = false;
+        device.save();
+        logger.info(`Reporting preset '${device.meta.reportingPreset}' applied to ${device.ieeeAddr}`, NS);
+    } catch (error) {
+        logger.debug(`Reporting preset still pending for ${device.ieeeAddr}: ${error.message}`, NS);
+    } finally {
+        presetsApplying.delete(device.ieeeAddr);
+    }
+}
+
+// Applies a pending reporting preset when the device reports
+const fz_pending_preset = ["msTemperatureMeasurement", "msRelativeHumidity", "genPowerCfg", "genBinaryInput"].map(
+    (cluster) => ({
+        cluster,
+        type: ["attributeReport", "readResponse"],
+        convert: (model, msg, publish, options, meta) => {
+            applyPendingPreset(meta.device, msg.endpoint);
+        },
+    }),
+);
 
 // Custom fromZigbee converter for contact events
 const fz_command_onoff_contact = {
@@ -18,14 +98,59 @@ const fz_command_onoff_contact = {
     },
 };
 
+// Contact state attribute, read on demand and reported with a heartbeat (true = closed)
+const fz_binary_input_contact = {
+    cluster: "genBinaryInput",
+    type: ["attributeReport", "readResponse"],
+    convert: (model, msg, publish, options, meta) => {
+        if (msg.data.presentValue !== undefined) {
+            return {contact: msg.data.presentValue === 1 || msg.data.presentValue === true};
+        }
+    },
+};
+
+// Select a reporting preset, it is kept in the device meta and applied again on reconfigure.
+// A sleeping device gets it with its next report instead.
+const tz_reporting_preset = {
+    key: ["reporting_preset"],
+    convertSet: async (entity, key, value, meta) => {
+        if (!reportingPresets[value]) {
+            throw new Error(`Unknown reporting preset '${value}'`);
+        }
+        meta.device.meta.reportingPreset = value;
+        meta.device.meta.reportingPresetPending = true;
+        meta.device.save();
+        try {
+            await configureReportingPreset(entity, value);
+            meta.device.meta.reportingPresetPending = false;
+            meta.device.save();
+        } catch (error) {
+            logger.warning(`Reporting preset '${value}' is applied with the next report of the device, ` +
+                `open or close the contact to wake it now (${error.message})`, NS);
+        }
+        return {state: {reporting_preset: value}};
+    },
+};
+
 export default {
     fingerprint: [{modelID: "Zicada", manufacturerName: "kernm.de"}],
     model: "Zicada",
     vendor: "kernm.de",
     description: "Multisensor with temperature, humidity, and contact sensors",
-    fromZigbee: [fz.temperature, fz.humidity, fz.battery, fz_command_onoff_contact],
-    toZigbee: [],
-    exposes: [e.temperature(), e.humidity(), e.battery(), e.contact()],
+    fromZigbee: [fz.temperature, fz.humidity, fz.battery, fz_command_onoff_contact, fz_binary_input_contact,
+        ...fz_pending_preset],
+    toZigbee: [tz_reporting_preset],
+    exposes: [
+        e.temperature(),
+        e.humidity(),
+        e.battery(),
+        e.contact(),
+        exposes
+            .enum("reporting_preset", ea.STATE_SET, Object.keys(reportingPresets))
+            .withDescription("Reporting intervals and change thresholds: low_airtime saves battery, " +
+                "responsive reports small changes quickly")
+            .withCategory("config"),
+    ],
     configure: async (device, coordinatorEndpoint, logger) => {
         const endpoint = device.getEndpoint(1);
 		await reporting.bind(
@@ -33,10 +158,13 @@ export default {
 		coordinatorEndpoint, [
 			"genPowerCfg",
             "msTemperatureMeasurement",
-			"msRelativeHumidity"
+			"msRelativeHumidity",
+			"genBinaryInput",
+			"genOnOff"
 		]);
-        await reporting.batteryPercentageRemaining(endpoint);
-		await reporting.temperature(endpoint);
-		await reporting.humidity(endpoint);		
+        await configureReportingPreset(endpoint, device.meta.reportingPreset ?? defaultReportingPreset);
+        device.meta.reportingPresetPending = false;
+        device.save();
+        await endpoint.read("genBinaryInput", ["presentValue"]);
     },
 };